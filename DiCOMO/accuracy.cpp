@@ -0,0 +1,321 @@
+//
+//  accuracy.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "accuracy.h"
+
+Accuracy::Accuracy() {
+    _phases.push_back(1);
+    _phases.push_back(3);
+
+    int sizes[] = {10, 30, 100};
+    _sizes.assign(sizes, sizes + sizeof(sizes)/sizeof(int));
+
+    _outputFilePath = "accuracy.json";
+
+    _setup = new Simulation(false);
+}
+
+Accuracy::~Accuracy() {
+    delete _setup;
+}
+
+bool Accuracy::setValues(int argc, const char * argv[]) {
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (argument == "-h") {
+            help();
+            return false;
+        } else if (argument == "-p" && hasValue) {
+            if (!parseList(argv[++i], _phases))
+                return false;
+        } else if (argument == "-s" && hasValue) {
+            if (!parseList(argv[++i], _sizes))
+                return false;
+        } else if (argument == "-o" && hasValue) {
+            _outputFilePath = argv[++i];
+        } else {
+            cout << "ERROR : Can not interpret <" << argument << ">" << endl;
+            help();
+            return false;
+        }
+    }
+
+    // The simulation falls back to its previous phases if not supported
+    Simulation check(_setup);
+    for (size_t i = 0; i < _phases.size(); i++) {
+        check.setPhases(_phases[i]);
+        if (check.getPhases() != _phases[i]) {
+            cout << "ERROR : <" << _phases[i] << "> phases are not supported." << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Accuracy::run() {
+    _scenarios.clear();
+
+    for (size_t p = 0; p < _phases.size(); p++) {
+        for (size_t s = 0; s < _sizes.size(); s++) {
+            accuracyScenario scenario;
+            scenario.phases = _phases[p];
+            scenario.houses = _sizes[s];
+
+            cout << setw(3) << scenario.phases << " phase(s)" << setw(8) << scenario.houses << " houses" << endl;
+
+            accuracyStates reference;
+            if (solveWith(ReferenceSolver, scenario.houses, scenario.phases, reference) < 0)
+                continue;
+
+            for (int solver = 0; solver < NumberOfSolvers; solver++) {
+                accuracyResult result;
+                result.solver = solver;
+
+                accuracyStates states;
+                result.seconds = solveWith(solver, scenario.houses, scenario.phases, states);
+                if (result.seconds < 0)
+                    continue;
+
+                compare(states, reference, result.voltage, result.current);
+
+                // Only a single phase feeder is a simple ladder
+                result.hasLadder = (scenario.phases == 1);
+                if (result.hasLadder) {
+                    accuracyStates ladder;
+                    solveLadder(scenario.houses, states, ladder);
+                    compare(states, ladder, result.ladderVoltage, result.ladderCurrent);
+                }
+
+                cout << setw(16) << Simulation::solverName(solver);
+                cout << scientific << setprecision(2);
+                cout << "   max |dV| " << result.voltage.maximum << " V";
+                cout << "   max |dI| " << result.current.maximum << " A";
+                cout << fixed << setprecision(3) << "   " << result.seconds * 1000.0 << " ms" << endl;
+
+                scenario.results.push_back(result);
+            }
+
+            _scenarios.push_back(scenario);
+        }
+    }
+
+    save();
+}
+
+#pragma mark PROTECTED
+
+void Accuracy::help() {
+    cout << "Usage: Accuracy [-p 1,3] [-s 10,30,100] [-o accuracy.json]" << endl;
+    cout << setw(6) << "-p" << "   Comma separated numbers of phases" << endl;
+    cout << setw(6) << "-s" << "   Comma separated numbers of houses" << endl;
+    cout << setw(6) << "-o" << "   JSON output file" << endl;
+}
+
+Simulation *Accuracy::buildFeeder(int houses, int phases) {
+    Simulation *simulation = new Simulation(_setup);
+    simulation->setPhases(phases);
+
+    // Same seed for every backend, so all of them solve the same feeder
+    srand(houses * 10 + phases);
+
+    // The voltage drop grows with the square of the houses per phase, so the
+    // segments are shortened accordingly to keep every feeder well within its
+    // point of voltage collapse
+    double segment = 10.0 * phases * phases / ((double)houses * houses);
+
+    for (int i = 0; i < houses; i++) {
+        int phase = (i % phases) + 1;
+        simulation->addFeederImpedanceForPhase(complex<double>(segment, 0.0), phase);
+        simulation->addReturnImpedance(complex<double>(segment / phases, 0.0));
+        simulation->addPowerToPhase((double)(rand()%350) + 150.0, (double)(rand()%21)/100.0 + 0.8, phase);
+    }
+
+    return simulation;
+}
+
+double Accuracy::solveWith(int solver, int houses, int phases, accuracyStates &states) {
+    Simulation *simulation = buildFeeder(houses, phases);
+    simulation->setSolver(solver);
+    if (!simulation->validate()) {
+        delete simulation;
+        return -1.0;
+    }
+    simulation->assemble();
+
+    double startTime = now();
+    simulation->solve();
+    double seconds = now() - startTime;
+
+    simulation->getElementStates(states.leftVoltages, states.rightVoltages, states.currents, states.impedances);
+    delete simulation;
+
+    return seconds;
+}
+
+void Accuracy::solveLadder(int houses, accuracyStates &given, accuracyStates &ladder) {
+    typedef complex<long double> complexLong;
+
+    // Return line segments come first, then consumer and feeder segment of
+    // each house. The source and the sink are the fixed ends of the first
+    // feeder and return segment
+    size_t length = houses;
+    complexLong source(given.leftVoltages[length+1].real(), given.leftVoltages[length+1].imag());
+    complexLong sink(given.rightVoltages[0].real(), given.rightVoltages[0].imag());
+
+    vector<complexLong> returns(length), feeders(length), loads(length);
+    for (size_t k = 0; k < length; k++) {
+        returns[k] = complexLong(given.impedances[k].real(), given.impedances[k].imag());
+        loads[k] = complexLong(given.impedances[length+2*k].real(), given.impedances[length+2*k].imag());
+        feeders[k] = complexLong(given.impedances[length+2*k+1].real(), given.impedances[length+2*k+1].imag());
+    }
+
+    // Impedance seen between the feeder and return node of each house,
+    // folded up from the end of the feeder
+    vector<complexLong> behind(length);
+    for (size_t k = length; k-- > 0;) {
+        complexLong downstream = (k+1 < length) ? feeders[k+1] + behind[k+1] + returns[k+1] : complexLong(INFINITY);
+        if (abs(loads[k]) == INFINITY)
+            behind[k] = downstream;
+        else if (abs(downstream) == INFINITY)
+            behind[k] = loads[k];
+        else
+            behind[k] = loads[k] * downstream / (loads[k] + downstream);
+    }
+
+    ladder.leftVoltages.assign(3*length, 0.0);
+    ladder.rightVoltages.assign(3*length, 0.0);
+    ladder.currents.assign(3*length, 0.0);
+    ladder.impedances = given.impedances;
+
+    // Sweep forward, each branch current splits into its load and the rest
+    complexLong current = (source - sink) / (feeders[0] + behind[0] + returns[0]);
+    complexLong upstream = source;
+    complexLong substation = sink;
+    for (size_t k = 0; k < length; k++) {
+        complexLong feederNode = upstream - current * feeders[k];
+        complexLong returnNode = substation + current * returns[k];
+        complexLong load = (abs(loads[k]) == INFINITY) ? 0.0L : (feederNode - returnNode) / loads[k];
+
+        ladder.leftVoltages[k] = complex<double>(returnNode);
+        ladder.rightVoltages[k] = complex<double>(substation);
+        ladder.currents[k] = complex<double>(current);
+
+        ladder.leftVoltages[length+2*k] = complex<double>(feederNode);
+        ladder.rightVoltages[length+2*k] = complex<double>(returnNode);
+        ladder.currents[length+2*k] = complex<double>(load);
+
+        ladder.leftVoltages[length+2*k+1] = complex<double>(upstream);
+        ladder.rightVoltages[length+2*k+1] = complex<double>(feederNode);
+        ladder.currents[length+2*k+1] = complex<double>(current);
+
+        current -= load;
+        upstream = feederNode;
+        substation = returnNode;
+    }
+}
+
+void Accuracy::compare(accuracyStates &states, accuracyStates &reference, accuracyError &voltage, accuracyError &current) {
+    voltage.maximum = voltage.rms = 0.0;
+    current.maximum = current.rms = 0.0;
+
+    size_t count = min(states.currents.size(), reference.currents.size());
+    if (count == 0)
+        return;
+
+    for (size_t i = 0; i < count; i++) {
+        double left = abs(states.leftVoltages[i] - reference.leftVoltages[i]);
+        double right = abs(states.rightVoltages[i] - reference.rightVoltages[i]);
+        double flow = abs(states.currents[i] - reference.currents[i]);
+
+        // Failed solutions give NaN, which must not be hidden by max()
+        if (left != left || right != right || flow != flow) {
+            voltage.maximum = voltage.rms = NAN;
+            current.maximum = current.rms = NAN;
+            return;
+        }
+
+        voltage.maximum = max(voltage.maximum, max(left, right));
+        voltage.rms += left*left + right*right;
+        current.maximum = max(current.maximum, flow);
+        current.rms += flow*flow;
+    }
+
+    voltage.rms = sqrt(voltage.rms / (2*count));
+    current.rms = sqrt(current.rms / count);
+}
+
+void Accuracy::save() {
+    stringstream text;
+    text << setprecision(9);
+    text << "{" << endl;
+    text << "  \"accuracy\": \"DiCOMO solver backends\"," << endl;
+    text << "  \"build\": \"" __DATE__ " " __TIME__ "\"," << endl;
+    text << "  \"reference\": \"" << Simulation::solverName(ReferenceSolver) << "\"," << endl;
+    text << "  \"scenarios\": [";
+
+    for (size_t i = 0; i < _scenarios.size(); i++) {
+        accuracyScenario &scenario = _scenarios[i];
+        text << (i ? "," : "") << endl << "    {\"phases\": " << scenario.phases;
+        text << ", \"houses\": " << scenario.houses << ", \"backends\": [";
+
+        for (size_t r = 0; r < scenario.results.size(); r++) {
+            accuracyResult &result = scenario.results[r];
+            text << (r ? "," : "") << endl << "      {\"solver\": \"" << Simulation::solverName(result.solver) << "\"";
+            text << ", \"seconds\": " << result.seconds;
+            appendError(text, "voltage", result.voltage);
+            appendError(text, "current", result.current);
+            if (result.hasLadder) {
+                appendError(text, "ladderVoltage", result.ladderVoltage);
+                appendError(text, "ladderCurrent", result.ladderCurrent);
+            } else {
+                text << ", \"ladderVoltage\": null, \"ladderCurrent\": null";
+            }
+            text << "}";
+        }
+        text << endl << "    ]}";
+    }
+    text << endl << "  ]" << endl << "}" << endl;
+
+    ofstream output(_outputFilePath.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << _outputFilePath << ">." << endl;
+        return;
+    }
+    output << text.str();
+    output.close();
+
+    cout << endl << "Accuracy results written to:" << endl << _outputFilePath << endl;
+}
+
+void Accuracy::appendError(stringstream &entry, const char *name, accuracyError &error) {
+    entry << ", \"" << name << "\": {\"max\": " << error.maximum << ", \"rms\": " << error.rms << "}";
+}
+
+bool Accuracy::parseList(const char *text, vector<int> &values) {
+    values.clear();
+
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        int value = atoi(item.c_str());
+        if (value <= 0) {
+            cout << "ERROR : Can not interpret <" << text << ">" << endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+
+    return !values.empty();
+}
+
+double Accuracy::now() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,104 @@
+//
+//  accuracy.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__accuracy__
+#define __DiCOMO__accuracy__
+
+//  Accuracy validation of the solver backends. The same synthetic feeder is
+//  solved by every backend of the simulation and the voltages and currents of
+//  all element ports are compared against the long double nodal reference.
+//  Single phase feeders form a ladder network, which is additionally solved
+//  in closed form with the load impedances each backend arrived at, so every
+//  backend is also checked against Kirchhoff's laws on its own terms. Maximum
+//  and RMS errors are written as JSON next to the solve time of each backend.
+
+#include "simulation.h"
+
+#include <chrono>
+
+// Maximum and RMS error of a set of values
+struct accuracyError {
+    double maximum;
+    double rms;
+};
+
+// Result of one backend on one scenario
+struct accuracyResult {
+    int solver;
+    double seconds;
+    accuracyError voltage;
+    accuracyError current;
+    // Only valid for single phase feeders
+    bool hasLadder;
+    accuracyError ladderVoltage;
+    accuracyError ladderCurrent;
+};
+
+// All backends on one feeder size and number of phases
+struct accuracyScenario {
+    int phases;
+    int houses;
+    vector<accuracyResult> results;
+};
+
+// States of all elements of a solved circuit
+struct accuracyStates {
+    vector< complex<double> > leftVoltages;
+    vector< complex<double> > rightVoltages;
+    vector< complex<double> > currents;
+    vector< complex<double> > impedances;
+};
+
+class Accuracy {
+protected:
+    vector<int> _phases;
+    vector<int> _sizes;
+    string _outputFilePath;
+
+    // Blank setup from which all synthetic feeders are copied
+    Simulation *_setup;
+
+    vector<accuracyScenario> _scenarios;
+
+public:
+    Accuracy();
+    ~Accuracy();
+
+    // All arguments passed are interpreted here
+    bool setValues(int argc, const char * argv[]);
+
+    // Runs all scenarios through all backends and writes the JSON file
+    void run();
+
+protected:
+    void help();
+
+    // Builds a synthetic feeder with houses spread evenly over the phases
+    Simulation *buildFeeder(int houses, int phases);
+
+    // Solves a new feeder with the given backend and collects its states.
+    // Returns the solve time in seconds, or a negative value on failure
+    double solveWith(int solver, int houses, int phases, accuracyStates &states);
+
+    // Solves a single phase ladder in closed form using the feeder and return
+    // impedances and the consumer impedances of the given states
+    void solveLadder(int houses, accuracyStates &given, accuracyStates &ladder);
+
+    // Compares the port voltages and currents of two sets of states
+    static void compare(accuracyStates &states, accuracyStates &reference, accuracyError &voltage, accuracyError &current);
+
+    void save();
+    static void appendError(stringstream &entry, const char *name, accuracyError &error);
+
+    // Parses a comma separated list of integers
+    static bool parseList(const char *text, vector<int> &values);
+
+    static double now();
+};
+
+#endif /* defined(__DiCOMO__accuracy__) */
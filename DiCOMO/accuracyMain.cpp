@@ -0,0 +1,18 @@
+//
+//  accuracyMain.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "accuracy.h"
+
+int main(int argc, const char * argv[])
+{
+    Accuracy *accuracy = new Accuracy();
+    if (accuracy->setValues(argc, argv))
+        accuracy->run();
+    delete accuracy;
+    return 0;
+}
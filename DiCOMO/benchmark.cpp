@@ -0,0 +1,496 @@
+//
+//  benchmark.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "benchmark.h"
+
+Benchmark::Benchmark() {
+    _phases.push_back(1);
+    _phases.push_back(3);
+
+    // Sizes from 10 to 100k houses in steps of roughly half a decade
+    int sizes[] = {10, 30, 100, 300, 1000, 3000, 10000, 30000, 100000};
+    _sizes.assign(sizes, sizes + sizeof(sizes)/sizeof(int));
+
+    _warmUps = 1;
+    _repetitions = 3;
+    _budget = BENCHMARK_BUDGET;
+    _outputFilePath = "benchmark.json";
+    _scratchPath = "benchmark_output";
+
+    _setup = new Simulation(false);
+    _counters = new PerfCounters();
+}
+
+Benchmark::~Benchmark() {
+    delete _setup;
+    delete _counters;
+}
+
+bool Benchmark::setValues(int argc, const char * argv[]) {
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (argument == "-h") {
+            help();
+            return false;
+        } else if (argument == "-p" && hasValue) {
+            if (!parseList(argv[++i], _phases))
+                return false;
+        } else if (argument == "-s" && hasValue) {
+            if (!parseList(argv[++i], _sizes))
+                return false;
+        } else if (argument == "-w" && hasValue) {
+            _warmUps = max(0, atoi(argv[++i]));
+        } else if (argument == "-r" && hasValue) {
+            _repetitions = max(1, atoi(argv[++i]));
+        } else if (argument == "-t" && hasValue) {
+            _budget = atof(argv[++i]);
+        } else if (argument == "-o" && hasValue) {
+            _outputFilePath = argv[++i];
+        } else if (argument == "-x" && hasValue) {
+            _scratchPath = argv[++i];
+        } else if (argument == "-e" && hasValue) {
+            if (!parseList(argv[++i], _bounds))
+                return false;
+            if (_bounds.size() != NumberOfBenchmarkStages) {
+                cout << "ERROR : Expected bounds for assembly, solve and output." << endl;
+                return false;
+            }
+        } else if (argument == "-n") {
+            delete _counters;
+            _counters = NULL;
+        } else {
+            cout << "ERROR : Can not interpret <" << argument << ">" << endl;
+            help();
+            return false;
+        }
+    }
+
+    // The simulation falls back to its previous phases if not supported
+    Simulation check(_setup);
+    for (size_t i = 0; i < _phases.size(); i++) {
+        check.setPhases(_phases[i]);
+        if (check.getPhases() != _phases[i]) {
+            cout << "ERROR : <" << _phases[i] << "> phases are not supported." << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Benchmark::run() {
+    _results.clear();
+
+    for (size_t p = 0; p < _phases.size(); p++) {
+        // Solve time of the last solved size, used to predict the next one
+        double lastSolve = 0.0;
+        int lastSize = 0;
+
+        for (size_t s = 0; s < _sizes.size(); s++) {
+            benchmarkResult result;
+            result.phases = _phases[p];
+            result.houses = _sizes[s];
+            result.elements = 3L * _sizes[s];
+            for (int c = 0; c < NumberOfPerfCounters; c++) {
+                result.assembly.counters[c] = 0.0;
+                result.solve.counters[c] = 0.0;
+                result.output.counters[c] = 0.0;
+            }
+
+            double expected = 0.0;
+            if (lastSize > 0)
+                expected = lastSolve * pow((double)_sizes[s] / lastSize, 3.0);
+            result.solved = (lastSize == 0 || expected <= _budget);
+
+            cout << setw(3) << result.phases << " phase(s)" << setw(8) << result.houses << " houses";
+            if (!result.solved)
+                cout << "   (solve skipped, expected " << fixed << setprecision(0) << expected << " s)";
+            cout << endl;
+
+            for (int i = 0; i < _warmUps; i++)
+                measure(result.houses, result.phases, result.solved, NULL);
+            for (int i = 0; i < _repetitions; i++)
+                measure(result.houses, result.phases, result.solved, &result);
+
+            if (result.solved) {
+                lastSolve = median(result.solve.seconds);
+                lastSize = result.houses;
+            }
+
+            _results.push_back(result);
+        }
+    }
+
+    bool withinBounds = checkComplexity();
+    save();
+
+    return withinBounds;
+}
+
+#pragma mark PROTECTED
+
+void Benchmark::help() {
+    cout << "Usage: Benchmark [-p 1,3] [-s 10,100,...] [-w 1] [-r 3] [-t 30] [-e 1.5,3.5,1.5] [-o benchmark.json] [-x benchmark_output] [-n]" << endl;
+    cout << setw(6) << "-p" << "   Comma separated numbers of phases" << endl;
+    cout << setw(6) << "-s" << "   Comma separated numbers of houses" << endl;
+    cout << setw(6) << "-w" << "   Warm-up repetitions per size" << endl;
+    cout << setw(6) << "-r" << "   Measured repetitions per size" << endl;
+    cout << setw(6) << "-t" << "   Seconds a single solve may be expected to take" << endl;
+    cout << setw(6) << "-e" << "   Largest complexity exponents of assembly, solve and output" << endl;
+    cout << setw(6) << "-o" << "   JSON output file" << endl;
+    cout << setw(6) << "-x" << "   Path of the CSV files written while timing the output" << endl;
+    cout << setw(6) << "-n" << "   No hardware performance counters" << endl;
+}
+
+Simulation *Benchmark::buildFeeder(int houses, int phases) {
+    Simulation *simulation = new Simulation(_setup);
+    simulation->setPhases(phases);
+
+    // Same seed for every repetition, so all repetitions solve the same feeder
+    srand(houses * 10 + phases);
+
+    for (int i = 0; i < houses; i++) {
+        int phase = (i % phases) + 1;
+        simulation->addFeederImpedanceForPhase(complex<double>(0.01*phases, 0.0), phase);
+        simulation->addReturnImpedance(complex<double>(0.01, 0.0));
+        simulation->addPowerToPhase((double)(rand()%350) + 150.0, (double)(rand()%21)/100.0 + 0.8, phase);
+    }
+
+    return simulation;
+}
+
+void Benchmark::measure(int houses, int phases, bool solve, benchmarkResult *result) {
+    // Assembly covers building the setup, validating and assembling
+    startCounters(result);
+    double startTime = now();
+    Simulation *simulation = buildFeeder(houses, phases);
+    if (!simulation->validate()) {
+        delete simulation;
+        return;
+    }
+    simulation->assemble();
+    double assemblyTime = now() - startTime;
+    if (result)
+        stopCounters(result->assembly);
+
+    double solveTime = 0.0;
+    if (solve) {
+        startCounters(result);
+        startTime = now();
+        simulation->solve();
+        solveTime = now() - startTime;
+        if (result)
+            stopCounters(result->solve);
+    }
+
+    startCounters(result);
+    startTime = now();
+    simulation->saveFeeders(_scratchPath);
+    simulation->saveSubstation(_scratchPath);
+    double outputTime = now() - startTime;
+    if (result)
+        stopCounters(result->output);
+
+    delete simulation;
+
+    if (result) {
+        result->assembly.seconds.push_back(assemblyTime);
+        if (solve)
+            result->solve.seconds.push_back(solveTime);
+        result->output.seconds.push_back(outputTime);
+    }
+}
+
+bool Benchmark::fitExponent(int phases, int stage, double &exponent) {
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    int points = 0;
+
+    for (size_t i = 0; i < _results.size(); i++) {
+        benchmarkStage &timings = stageOf(_results[i], stage);
+        if (_results[i].phases != phases || timings.seconds.empty())
+            continue;
+
+        double seconds = median(timings.seconds);
+        if (seconds < BENCHMARK_FIT_MINIMUM)
+            continue;
+
+        double x = log((double)_results[i].houses);
+        double y = log(seconds);
+        sumX += x;
+        sumY += y;
+        sumXX += x*x;
+        sumXY += x*y;
+        points++;
+    }
+
+    double spread = points * sumXX - sumX * sumX;
+    if (points < 2 || spread <= 0.0)
+        return false;
+
+    exponent = (points * sumXY - sumX * sumY) / spread;
+    return true;
+}
+
+bool Benchmark::checkComplexity() {
+    _complexities.clear();
+    bool withinBounds = true;
+
+    cout << endl << "Complexity exponents:" << endl;
+    for (size_t p = 0; p < _phases.size(); p++) {
+        benchmarkComplexity complexity;
+        complexity.phases = _phases[p];
+
+        cout << setw(3) << complexity.phases << " phase(s)";
+        for (int stage = 0; stage < NumberOfBenchmarkStages; stage++) {
+            complexity.fitted[stage] = fitExponent(complexity.phases, stage, complexity.exponents[stage]);
+
+            cout << "   " << stageName(stage) << " ";
+            if (!complexity.fitted[stage]) {
+                cout << "n/a";
+                continue;
+            }
+            cout << fixed << setprecision(2) << complexity.exponents[stage];
+
+            if (!_bounds.empty() && complexity.exponents[stage] > _bounds[stage]) {
+                cout << " (exceeds " << _bounds[stage] << ")";
+                withinBounds = false;
+            }
+        }
+        cout << endl;
+
+        _complexities.push_back(complexity);
+    }
+
+    if (!withinBounds)
+        cout << "ERROR : Complexity exceeds its bound." << endl;
+
+    return withinBounds;
+}
+
+void Benchmark::save() {
+    string text = "{\n";
+    text += "  \"benchmark\": \"DiCOMO scaling\",\n";
+    text += "  \"build\": \"" __DATE__ " " __TIME__ "\",\n";
+
+    stringstream settings;
+    settings << "  \"warmUps\": " << _warmUps << ",\n";
+    settings << "  \"repetitions\": " << _repetitions << ",\n";
+    settings << "  \"budget\": " << _budget << ",\n";
+    settings << "  \"perfCounters\": [";
+    bool first = true;
+    for (int c = 0; _counters && c < NumberOfPerfCounters; c++) {
+        if (!_counters->isAvailable(c))
+            continue;
+        settings << (first ? "" : ", ") << "\"" << PerfCounters::counterName(c) << "\"";
+        first = false;
+    }
+    settings << "],\n";
+    settings << "  \"bounds\": ";
+    if (_bounds.empty()) {
+        settings << "null,\n";
+    } else {
+        settings << "{";
+        for (int stage = 0; stage < NumberOfBenchmarkStages; stage++)
+            settings << (stage ? ", " : "") << "\"" << stageName(stage) << "\": " << _bounds[stage];
+        settings << "},\n";
+    }
+    text += settings.str();
+
+    // Fitted exponents per number of phases, null if not enough sizes
+    stringstream complexities;
+    complexities << setprecision(6);
+    complexities << "  \"complexity\": [";
+    for (size_t i = 0; i < _complexities.size(); i++) {
+        benchmarkComplexity &complexity = _complexities[i];
+        complexities << (i ? "," : "") << "\n    {\"phases\": " << complexity.phases;
+        for (int stage = 0; stage < NumberOfBenchmarkStages; stage++) {
+            complexities << ", \"" << stageName(stage) << "\": ";
+            if (complexity.fitted[stage])
+                complexities << complexity.exponents[stage];
+            else
+                complexities << "null";
+        }
+        complexities << "}";
+    }
+    complexities << "\n  ],\n";
+    text += complexities.str();
+
+    text += "  \"results\": [";
+    for (size_t i = 0; i < _results.size(); i++) {
+        benchmarkResult &result = _results[i];
+        stringstream entry;
+        entry << (i ? "," : "") << "\n    {\"phases\": " << result.phases;
+        entry << ", \"houses\": " << result.houses;
+        entry << ", \"elements\": " << result.elements;
+        entry << ", \"solved\": " << (result.solved ? "true" : "false") << ",\n";
+        text += entry.str();
+
+        appendStage(text, "assembly", result.assembly, result.elements);
+        text += ",\n";
+        appendStage(text, "solve", result.solve, result.elements);
+        text += ",\n";
+        appendStage(text, "output", result.output, result.elements);
+        text += "}";
+    }
+    text += "\n  ]\n}\n";
+
+    ofstream output(_outputFilePath.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << _outputFilePath << ">." << endl;
+        return;
+    }
+    output << text;
+    output.close();
+
+    remove((_scratchPath + ".csv").c_str());
+    remove((_scratchPath + "s.csv").c_str());
+
+    cout << endl << "Benchmark results written to:" << endl << _outputFilePath << endl;
+}
+
+void Benchmark::startCounters(benchmarkResult *result) {
+    // Warm-up repetitions are not counted
+    if (result && _counters)
+        _counters->start();
+}
+
+void Benchmark::stopCounters(benchmarkStage &stage) {
+    if (!_counters)
+        return;
+
+    _counters->stop();
+    for (int c = 0; c < NumberOfPerfCounters; c++)
+        stage.counters[c] += _counters->getValue(c);
+}
+
+void Benchmark::appendStage(string &text, const char *name, benchmarkStage &stage, long elements) {
+    stringstream entry;
+    entry << setprecision(9);
+    entry << "     \"" << name << "\": {";
+
+    if (stage.seconds.empty()) {
+        entry << "\"median\": null, \"min\": null, \"max\": null, \"seconds\": [], \"counters\": null}";
+        text += entry.str();
+        return;
+    }
+
+    entry << "\"median\": " << median(stage.seconds);
+    entry << ", \"min\": " << *min_element(stage.seconds.begin(), stage.seconds.end());
+    entry << ", \"max\": " << *max_element(stage.seconds.begin(), stage.seconds.end());
+    entry << ", \"seconds\": [";
+    for (size_t i = 0; i < stage.seconds.size(); i++)
+        entry << (i ? ", " : "") << stage.seconds[i];
+    entry << "]";
+
+    if (!_counters || !_counters->isAvailable()) {
+        entry << ", \"counters\": null}";
+        text += entry.str();
+        return;
+    }
+
+    // Counters per repetition, or null where not available
+    double repetitions = stage.seconds.size();
+    entry << ",\n      \"counters\": {";
+    for (int c = 0; c < NumberOfPerfCounters; c++) {
+        entry << (c ? ", " : "") << "\"" << PerfCounters::counterName(c) << "\": ";
+        if (_counters->isAvailable(c))
+            entry << stage.counters[c] / repetitions;
+        else
+            entry << "null";
+    }
+
+    entry << ", \"ipc\": ";
+    if (_counters->isAvailable(CyclesCounter) && _counters->isAvailable(InstructionsCounter)
+        && stage.counters[CyclesCounter] > 0)
+        entry << stage.counters[InstructionsCounter] / stage.counters[CyclesCounter];
+    else
+        entry << "null";
+
+    // Misses per element of the circuit
+    entry << ", \"missesPerElement\": {";
+    int misses[] = {L1DMissCounter, LLCMissCounter, BranchMissCounter, DTLBMissCounter};
+    for (int m = 0; m < 4; m++) {
+        entry << (m ? ", " : "") << "\"" << PerfCounters::counterName(misses[m]) << "\": ";
+        if (_counters->isAvailable(misses[m]))
+            entry << stage.counters[misses[m]] / repetitions / elements;
+        else
+            entry << "null";
+    }
+    entry << "}}}";
+
+    text += entry.str();
+}
+
+double Benchmark::median(vector<double> values) {
+    if (values.empty())
+        return 0.0;
+
+    sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    if (values.size() % 2)
+        return values[middle];
+    return 0.5 * (values[middle-1] + values[middle]);
+}
+
+benchmarkStage &Benchmark::stageOf(benchmarkResult &result, int stage) {
+    switch (stage) {
+        case AssemblyBenchmark:     return result.assembly;
+        case SolveBenchmark:        return result.solve;
+        default:                    return result.output;
+    }
+}
+
+const char *Benchmark::stageName(int stage) {
+    switch (stage) {
+        case AssemblyBenchmark:     return "assembly";
+        case SolveBenchmark:        return "solve";
+        case OutputBenchmark:       return "output";
+        default:                    return "unknown";
+    }
+}
+
+bool Benchmark::parseList(const char *text, vector<int> &values) {
+    values.clear();
+
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        int value = atoi(item.c_str());
+        if (value <= 0) {
+            cout << "ERROR : Can not interpret <" << text << ">" << endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+
+    return !values.empty();
+}
+
+bool Benchmark::parseList(const char *text, vector<double> &values) {
+    values.clear();
+
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        double value = atof(item.c_str());
+        if (value <= 0.0) {
+            cout << "ERROR : Can not interpret <" << text << ">" << endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+
+    return !values.empty();
+}
+
+double Benchmark::now() {
+    // Monotonic wall-clock time, unaffected by the number of threads
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
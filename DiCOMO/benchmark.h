@@ -0,0 +1,141 @@
+//
+//  benchmark.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__benchmark__
+#define __DiCOMO__benchmark__
+
+//  Scaling benchmark of the simulation. Synthetic feeders of a given number of
+//  houses are built through the public simulation interface for one or more
+//  phases. Assembly, solve and output are timed separately with wall-clock
+//  timers over a number of warm-up and measured repetitions, and the results
+//  are written as JSON so they can be compared between versions. Where the
+//  system permits, hardware performance counters are read around each stage.
+//  From the timings of all sizes the empirical complexity exponent of each
+//  stage is fitted, and the benchmark fails if an exponent exceeds its bound.
+
+#include "simulation.h"
+#include "perfCounters.h"
+
+#include <chrono>
+
+// Default seconds a single solve may be expected to take before larger
+// feeders are no longer solved
+#define BENCHMARK_BUDGET        30.0
+
+// Sizes whose median stage time is below this many seconds are dominated by
+// fixed costs and left out of the complexity fit
+#define BENCHMARK_FIT_MINIMUM   1e-3
+
+enum benchmarkStageIndex {
+    AssemblyBenchmark       = 0,
+    SolveBenchmark          = 1,
+    OutputBenchmark         = 2,
+    NumberOfBenchmarkStages = 3,
+};
+
+// Timings of one stage over all measured repetitions and its hardware
+// counters summed over them
+struct benchmarkStage {
+    vector<double> seconds;
+    double counters[NumberOfPerfCounters];
+};
+
+// Result of one feeder size and number of phases
+struct benchmarkResult {
+    int phases;
+    int houses;
+    long elements;
+    bool solved;
+    benchmarkStage assembly;
+    benchmarkStage solve;
+    benchmarkStage output;
+};
+
+// Fitted exponent of time over houses of each stage for one number of phases
+struct benchmarkComplexity {
+    int phases;
+    bool fitted[NumberOfBenchmarkStages];
+    double exponents[NumberOfBenchmarkStages];
+};
+
+class Benchmark {
+protected:
+    vector<int> _phases;
+    vector<int> _sizes;
+    int _warmUps;
+    int _repetitions;
+
+    // The solver scales roughly cubically with the number of houses. Sizes
+    // whose solve is expected to exceed the budget are only assembled and
+    // written, and reported as not solved
+    double _budget;
+
+    string _outputFilePath;
+    string _scratchPath;
+
+    // Blank setup from which all synthetic feeders are copied
+    Simulation *_setup;
+
+    // Hardware counters, NULL if switched off
+    PerfCounters *_counters;
+
+    // Largest exponent each stage may show, none if empty
+    vector<double> _bounds;
+
+    vector<benchmarkResult> _results;
+    vector<benchmarkComplexity> _complexities;
+
+public:
+    Benchmark();
+    ~Benchmark();
+
+    // All arguments passed are interpreted here
+    bool setValues(int argc, const char * argv[]);
+
+    // Runs all sizes for all numbers of phases and writes the JSON file.
+    // Returns false if a complexity exponent exceeds its bound
+    bool run();
+
+protected:
+    void help();
+
+    // Builds a synthetic feeder with houses spread evenly over the phases
+    Simulation *buildFeeder(int houses, int phases);
+
+    // Runs one repetition. Timings are only recorded if a result is given,
+    // warm-up repetitions pass NULL
+    void measure(int houses, int phases, bool solve, benchmarkResult *result);
+
+    // Least squares fit of log(time) over log(houses) for all sizes of the
+    // given number of phases. Returns false if fewer than two sizes qualify
+    bool fitExponent(int phases, int stage, double &exponent);
+
+    // Fits all exponents and compares them against the bounds
+    bool checkComplexity();
+
+    void save();
+
+    // Starts the counters of a measured stage and adds them to it when done
+    void startCounters(benchmarkResult *result);
+    void stopCounters(benchmarkStage &stage);
+
+    // Writes a stage as JSON object with its statistics and raw timings.
+    // Counters are given per repetition, misses also per element
+    void appendStage(string &text, const char *name, benchmarkStage &stage, long elements);
+    static double median(vector<double> values);
+    static benchmarkStage &stageOf(benchmarkResult &result, int stage);
+    static const char *stageName(int stage);
+
+    // Parses a comma separated list of positive integers or numbers
+    static bool parseList(const char *text, vector<int> &values);
+    static bool parseList(const char *text, vector<double> &values);
+
+    static double now();
+};
+
+#endif /* defined(__DiCOMO__benchmark__) */
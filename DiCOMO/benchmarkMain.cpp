@@ -0,0 +1,19 @@
+//
+//  benchmarkMain.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "benchmark.h"
+
+int main(int argc, const char * argv[])
+{
+    Benchmark *benchmark = new Benchmark();
+    int status = 0;
+    if (benchmark->setValues(argc, argv) && !benchmark->run())
+        status = 1;
+    delete benchmark;
+    return status;
+}
@@ -51,6 +51,7 @@ complex<double> Consumer::getPower() {
 }
 
 complex<double> Consumer::getImpedanceInDirectionOf(string mine) {
+    ImpedanceProbe probe;
     
     // If the apparent power consumption is zero then return an open circuit
     if (getPower().real() == 0.0 && getPower().imag() == 0.0)
@@ -0,0 +1,128 @@
+//
+//  csvWriter.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "csvWriter.h"
+
+CSVWriter::CSVWriter(string path, size_t blockSize) {
+    _path = path;
+    _used = 0;
+    _block.resize(blockSize > 0 ? blockSize : CSV_BLOCK_SIZE);
+
+    _file = fopen(path.c_str(), "wb");
+}
+
+CSVWriter::~CSVWriter() {
+    close();
+}
+
+bool CSVWriter::isOpen() {
+    return _file != NULL;
+}
+
+void CSVWriter::write(const char *text, size_t length) {
+    if (!_file)
+        return;
+
+    // Make room for the text
+    if (_used + length > _block.size())
+        flush();
+
+    if (length > _block.size()) {
+        // Text that does not fit into a block at all is written directly
+        fwrite(text, 1, length, _file);
+    } else {
+        memcpy(&_block[_used], text, length);
+        _used += length;
+    }
+}
+
+void CSVWriter::write(const string &text) {
+    write(text.data(), text.size());
+}
+
+void CSVWriter::writeRows(const vector<string> &names, const vector<double> &values, size_t columns) {
+    size_t rows = names.size();
+    if (rows * columns != values.size()) {
+        cout << "ERROR : Rows and values do not match for <" << _path << ">." << endl;
+        return;
+    }
+
+    // Small tables are not worth any threads
+    if (rows <= CSV_ROWS_PER_CHUNK) {
+        string text;
+        formatRows(&names, &values, columns, 0, rows, &text);
+        write(text);
+        return;
+    }
+
+    unsigned int threads = thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    // Format a batch of chunks in parallel and write them in order before
+    // the next batch is formatted
+    vector<string> texts(threads);
+    size_t row = 0;
+    while (row < rows) {
+        vector<thread> workers;
+        size_t chunks = 0;
+
+        for (; chunks < threads && row < rows; chunks++) {
+            size_t lastRow = min(row + CSV_ROWS_PER_CHUNK, rows);
+            texts[chunks].clear();
+            workers.push_back(thread(formatRows, &names, &values, columns, row, lastRow, &texts[chunks]));
+            row = lastRow;
+        }
+
+        for (size_t i = 0; i < chunks; i++) {
+            workers[i].join();
+            write(texts[i]);
+        }
+    }
+}
+
+void CSVWriter::close() {
+    if (!_file)
+        return;
+
+    flush();
+    fclose(_file);
+    _file = NULL;
+}
+
+void CSVWriter::appendValue(string &text, double value) {
+    // An ofstream prints doubles with a precision of 6 in general notation
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%g", value);
+    text.append(buffer, length);
+}
+
+#pragma mark PROTECTED
+
+void CSVWriter::flush() {
+    if (_used > 0)
+        fwrite(&_block[0], 1, _used, _file);
+    _used = 0;
+}
+
+void CSVWriter::formatRows(const vector<string> *names, const vector<double> *values, size_t columns, size_t firstRow, size_t lastRow, string *text) {
+    // Roughly 12 characters per value
+    text->reserve((lastRow - firstRow) * (columns + 2) * 12);
+
+    for (size_t row = firstRow; row < lastRow; row++) {
+        text->append((*names)[row]);
+
+        const double *value = &(*values)[row * columns];
+        for (size_t column = 0; column < columns; column++) {
+            text->push_back(',');
+            appendValue(*text, value[column]);
+        }
+
+        text->push_back('\n');
+    }
+}
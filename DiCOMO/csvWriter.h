@@ -0,0 +1,66 @@
+//
+//  csvWriter.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__csvWriter__
+#define __DiCOMO__csvWriter__
+
+//  A buffered writer for CSV output. Text is collected in a large block that
+//  is only written to file once it is full. Numbers are formatted exactly as
+//  an ofstream with default settings would print them ("%g"), so files are
+//  byte-identical to streamed output. Large tables are formatted in parallel
+//  chunks that are written in their original order.
+
+#include "backbone.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+// Size of the block that is filled before writing to file
+#define CSV_BLOCK_SIZE          (1024 * 1024)
+
+// Number of rows each thread formats at a time
+#define CSV_ROWS_PER_CHUNK      4096
+
+class CSVWriter {
+protected:
+    string _path;
+    FILE *_file;
+
+    // Text that has not been written yet
+    vector<char> _block;
+    size_t _used;
+
+public:
+    CSVWriter(string path, size_t blockSize = CSV_BLOCK_SIZE);
+    ~CSVWriter();
+
+    bool isOpen();
+
+    // Appends text to the block and writes the block when it is full
+    void write(const char *text, size_t length);
+    void write(const string &text);
+
+    // Writes rows of the form "name,value,...,value\n" where each row has
+    // columns values. Tables larger than one chunk are formatted in parallel
+    void writeRows(const vector<string> &names, const vector<double> &values, size_t columns);
+
+    // Writes the remaining block and closes the file
+    void close();
+
+    // Appends a value formatted like "output << value"
+    static void appendValue(string &text, double value);
+
+protected:
+    void flush();
+
+    // Formats a range of rows into text
+    static void formatRows(const vector<string> *names, const vector<double> *values, size_t columns, size_t firstRow, size_t lastRow, string *text);
+};
+
+#endif /* defined(__DiCOMO__csvWriter__) */
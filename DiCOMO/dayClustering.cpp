@@ -0,0 +1,337 @@
+//
+//  dayClustering.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "dayClustering.h"
+
+DayClustering::DayClustering(Simulation *setup, IrishData *irishData, int startHouse, int houses, double powerFactor) {
+    _setup = setup;
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _houses = houses;
+    _powerFactor = powerFactor;
+
+    _clusters = 1;
+    _threads = 1;
+    _days = 0;
+    _iterations = 0;
+    memset(&_full, 0, sizeof(dayMetrics));
+    memset(&_representative, 0, sizeof(dayMetrics));
+}
+
+DayClustering::~DayClustering() {
+    while (!_workers.empty()) {
+        delete _workers.back();
+        _workers.pop_back();
+    }
+}
+
+void DayClustering::setClusters(int clusters) {
+    _clusters = max(1, clusters);
+}
+
+void DayClustering::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+bool DayClustering::run() {
+    buildShapes();
+    if (_days < _clusters) {
+        cout << "ERROR : " << _days << " complete day(s) can not form " << _clusters << " clusters." << endl;
+        return false;
+    }
+
+    double startTime = Metrics::now();
+    size_t length = IRISH_SAMPLES_PER_DAY;
+
+    // The day closest to the mean shape, then always the day farthest from
+    // its nearest medoid
+    vector<double> mean(length, 0.0);
+    for (int d = 0; d < _days; d++)
+        for (size_t t = 0; t < length; t++)
+            mean[t] += _shapes[d*length + t] / _days;
+
+    _medoids.clear();
+    vector<double> nearest(_days, INFINITY);
+    int next = 0;
+    for (int d = 1; d < _days; d++)
+        if (squaredDistance(&_shapes[d*length], &mean[0], length) < squaredDistance(&_shapes[next*length], &mean[0], length))
+            next = d;
+    while (true) {
+        _medoids.push_back(next);
+        if (_medoids.size() == (size_t) _clusters)
+            break;
+        int added = next;
+        for (int d = 0; d < _days; d++)
+            nearest[d] = min(nearest[d], squaredDistance(&_shapes[d*length], &_shapes[added*length], length));
+        for (int d = 0; d < _days; d++)
+            if (nearest[d] > nearest[next])
+                next = d;
+    }
+
+    // Alternate between assigning the days and moving the medoids
+    int threads = min(_threads, _days);
+    _assignments.assign(_days, -1);
+    for (_iterations = 1; _iterations <= CLUSTERING_ITERATIONS; _iterations++) {
+        vector<int> moved(threads, 0);
+        vector<thread> workers;
+        int first = 0;
+        for (int t = 0; t < threads; t++) {
+            int count = _days / threads + (t < _days % threads ? 1 : 0);
+            workers.push_back(thread(&DayClustering::assignDays, this, first, first + count, &moved[t]));
+            first += count;
+        }
+        for (int t = 0; t < threads; t++)
+            workers[t].join();
+
+        bool changed = false;
+        for (int c = 0; c < _clusters; c++) {
+            int best = _medoids[c];
+            double lowest = INFINITY;
+            for (int d = 0; d < _days; d++) {
+                if (_assignments[d] != c)
+                    continue;
+                double sum = 0.0;
+                for (int other = 0; other < _days && sum < lowest; other++)
+                    if (_assignments[other] == c)
+                        sum += squaredDistance(&_shapes[d*length], &_shapes[other*length], length);
+                if (sum < lowest) {
+                    lowest = sum;
+                    best = d;
+                }
+            }
+            changed = changed || (best != _medoids[c]);
+            _medoids[c] = best;
+        }
+
+        int movedDays = 0;
+        for (int t = 0; t < threads; t++)
+            movedDays += moved[t];
+        if (!changed && movedDays == 0)
+            break;
+    }
+    double clusteringTime = Metrics::now() - startTime;
+
+    cout << "Days :" << setw(23) << _days << " in " << _clusters << " clusters after " << _iterations << " iteration(s)";
+    cout << " in " << fixed << setprecision(3) << clusteringTime * 1000 << " ms" << endl;
+
+    // Every day is solved to compare against
+    for (int i = (int) _workers.size(); i < threads; i++)
+        _workers.push_back(new Simulation(_setup));
+    _dayResults.assign(_days, dayMetrics());
+
+    startTime = Metrics::now();
+    vector<thread> workers;
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        int count = _days / threads + (t < _days % threads ? 1 : 0);
+        workers.push_back(thread(&DayClustering::solveDays, this, t, first, first + count));
+        first += count;
+    }
+    for (int t = 0; t < threads; t++)
+        workers[t].join();
+    double solveTime = Metrics::now() - startTime;
+
+    for (int d = 0; d < _days; d++) {
+        if (_dayResults[d].demand != _dayResults[d].demand) {
+            cout << "ERROR : Day " << d << " could not be solved." << endl;
+            return false;
+        }
+    }
+
+    vector<int> days, ones(_days, 1), weights;
+    for (int d = 0; d < _days; d++)
+        days.push_back(d);
+    for (int c = 0; c < _clusters; c++)
+        weights.push_back(getWeight(c));
+    _full = combine(days, ones);
+    _representative = combine(_medoids, weights);
+
+    cout << "Solves :" << setw(21) << _days * IRISH_SAMPLES_PER_DAY << " in " << setprecision(1) << solveTime * 1000 << " ms, ";
+    cout << _clusters * IRISH_SAMPLES_PER_DAY << " of them on representative days" << endl;
+    cout << "Energy error :" << setw(15) << setprecision(2) << 100.0 * (_representative.demand - _full.demand) / _full.demand << " %" << endl;
+    cout << "Loss error :" << setw(17) << 100.0 * (_representative.losses - _full.losses) / _full.losses << " %" << endl;
+
+    return true;
+}
+
+bool DayClustering::save(string path) {
+    string file = path + "_days.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "Cluster,Medoid day,First sample,Weight (days),Days" << endl;
+    for (int c = 0; c < _clusters; c++) {
+        output << c << "," << _medoids[c] << "," << _medoids[c] * IRISH_SAMPLES_PER_DAY << "," << getWeight(c) << ",";
+        bool separate = false;
+        for (int d = 0; d < _days; d++) {
+            if (_assignments[d] != c)
+                continue;
+            output << (separate ? " " : "") << d;
+            separate = true;
+        }
+        output << endl;
+    }
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    file = path + "_days_error.csv";
+    output.open(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    const char *names[5] = {"Energy (kWh)", "Losses (kWh)", "Peak (kW)", "Lowest voltage (V)", "Hours below limit"};
+    double full[5] = {_full.demand, _full.losses, _full.peak, _full.lowest, _full.hoursBelow};
+    double representative[5] = {_representative.demand, _representative.losses, _representative.peak, _representative.lowest, _representative.hoursBelow};
+    output << "Metric,Full,Representative,Error (%)" << endl;
+    for (int i = 0; i < 5; i++) {
+        output << names[i] << "," << setprecision(10) << full[i] << "," << representative[i] << ",";
+        output << ((full[i] != 0.0) ? 100.0 * (representative[i] - full[i]) / full[i] : 0.0) << endl;
+    }
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    return true;
+}
+
+int DayClustering::getMedoid(int cluster) {
+    if (cluster < 0 || cluster >= _medoids.size())
+        return -1;
+    return _medoids[cluster];
+}
+
+int DayClustering::getWeight(int cluster) {
+    int weight = 0;
+    for (size_t d = 0; d < _assignments.size(); d++)
+        if (_assignments[d] == cluster)
+            weight++;
+    return weight;
+}
+
+double DayClustering::squaredDistance(const double *first, const double *second, size_t length) {
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            double difference = first[i+lane] - second[i+lane];
+            sums[lane] += difference * difference;
+        }
+    }
+    for (; i < length; i++) {
+        double difference = first[i] - second[i];
+        sums[0] += difference * difference;
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+#pragma mark PROTECTED
+
+void DayClustering::buildShapes() {
+    size_t length = IRISH_SAMPLES_PER_DAY;
+    dataSize size = _irishData->getDataSize();
+    _days = (int)(size.samples / length);
+    _shapes.assign(_days * length, 0.0);
+
+    for (int i = 0; i < _houses; i++)
+        for (size_t sample = 0; sample < _days * length; sample++)
+            _shapes[sample] += _irishData->getSampleForHouse((int) sample, _startHouse + i);
+}
+
+void DayClustering::assignDays(int first, int last, int *moved) {
+    size_t length = IRISH_SAMPLES_PER_DAY;
+    for (int d = first; d < last; d++) {
+        int best = 0;
+        double lowest = INFINITY;
+        for (int c = 0; c < _clusters; c++) {
+            double distance = squaredDistance(&_shapes[d*length], &_shapes[_medoids[c]*length], length);
+            if (distance < lowest) {
+                lowest = distance;
+                best = c;
+            }
+        }
+        if (_assignments[d] != best)
+            (*moved)++;
+        _assignments[d] = best;
+    }
+}
+
+void DayClustering::solveDays(int worker, int first, int last) {
+    Simulation *simulation = _workers[worker];
+    double hours = 24.0 / IRISH_SAMPLES_PER_DAY;
+    double limit = SCREENING_LOWER * abs(_setup->getSource() - _setup->getSink());
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    vector<double> voltages;
+    for (int d = first; d < last; d++) {
+        dayMetrics &result = _dayResults[d];
+        memset(&result, 0, sizeof(dayMetrics));
+        result.lowest = INFINITY;
+
+        for (int t = 0; t < IRISH_SAMPLES_PER_DAY; t++) {
+            simulation->clearPowers();
+            _irishData->applyProfilesToSim(simulation, _startHouse, _houses, d * IRISH_SAMPLES_PER_DAY + t, _powerFactor, simulation->getPhases());
+            if (!simulation->updatePowers()) {
+                if (!simulation->validate()) {
+                    result.demand = NAN;
+                    return;
+                }
+                simulation->assemble();
+            }
+            simulation->solve();
+            if (!simulation->hasConverged()) {
+                result.demand = NAN;
+                return;
+            }
+
+            int n = simulation->getConnectionCount();
+            double demand = 0.0;
+            for (int k = 0; k < n; k++)
+                demand += simulation->getConnectionPower(k).real();
+
+            // The return line first, then pairs of consumer and feeder
+            double losses = 0.0;
+            simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+            for (int i = 0; i < n; i++) {
+                losses += norm(currents[i]) * impedances[i].real();
+                losses += norm(currents[n + 2*i + 1]) * impedances[n + 2*i + 1].real();
+            }
+
+            simulation->getConnectionVoltages(voltages);
+            double lowest = *min_element(voltages.begin(), voltages.end());
+
+            result.demand += demand * hours / 1000.0;
+            result.losses += losses * hours / 1000.0;
+            result.peak = max(result.peak, demand / 1000.0);
+            result.lowest = min(result.lowest, lowest);
+            if (lowest < limit)
+                result.hoursBelow += hours;
+        }
+    }
+}
+
+dayMetrics DayClustering::combine(const vector<int> &days, const vector<int> &weights) {
+    dayMetrics result;
+    memset(&result, 0, sizeof(dayMetrics));
+    result.lowest = INFINITY;
+
+    for (size_t i = 0; i < days.size(); i++) {
+        if (weights[i] == 0)
+            continue;
+        dayMetrics &day = _dayResults[days[i]];
+        result.demand += weights[i] * day.demand;
+        result.losses += weights[i] * day.losses;
+        result.hoursBelow += weights[i] * day.hoursBelow;
+        result.peak = max(result.peak, day.peak);
+        result.lowest = min(result.lowest, day.lowest);
+    }
+    return result;
+}
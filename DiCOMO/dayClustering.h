@@ -0,0 +1,116 @@
+//
+//  dayClustering.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__dayClustering__
+#define __DiCOMO__dayClustering__
+
+//  Representative days of the Irish data for the houses of a feeder. The
+//  summed power of the houses over every complete day is one shape of
+//  IRISH_SAMPLES_PER_DAY samples, and the shapes are clustered by k-medoids
+//  on their squared Euclidean distance. Medoids are days of the data, so a
+//  time-series can be run on them directly, each weighted by the number of
+//  days in its cluster.
+//
+//  The medoids start from the day closest to the mean shape, followed by
+//  the day farthest from all medoids so far, so the result does not depend
+//  on any random numbers. Assigning the days to their nearest medoid is
+//  split over the threads, and each medoid then moves to the member with
+//  the lowest sum of distances to all others, until no medoid moves.
+//
+//  To report the error of the representation, every day is solved and the
+//  energy drawn, the energy lost in the feeder, the peak demand, the lowest
+//  voltage and the time below the lower screening limit of all days are
+//  compared against those of the weighted representative days.
+
+#include "simulation.h"
+#include "irishData.h"
+
+#include <thread>
+#include <mutex>
+
+// Most assignment passes of the k-medoids iteration
+#define CLUSTERING_ITERATIONS   100
+
+// Aggregated results of the samples of one or several days
+struct dayMetrics {
+    double demand;          // energy drawn by the houses in kWh
+    double losses;          // energy lost in the feeder in kWh
+    double peak;            // highest demand of all houses together in kW
+    double lowest;          // lowest voltage at any house in V
+    double hoursBelow;      // hours with any house below the lower limit
+};
+
+class DayClustering {
+protected:
+    // Feeder and return impedances, voltages and solver. Its powers are
+    // replaced by the days
+    Simulation *_setup;
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _houses;
+    double _powerFactor;
+
+    int _clusters;
+    int _threads;
+
+    // Summed power of the houses, one complete day after the other
+    vector<double> _shapes;
+    int _days;
+
+    // Medoid day of every cluster and cluster of every day
+    vector<int> _medoids;
+    vector<int> _assignments;
+    int _iterations;
+
+    // One simulation per thread and the results of every day
+    vector<Simulation *> _workers;
+    vector<dayMetrics> _dayResults;
+    dayMetrics _full;
+    dayMetrics _representative;
+
+    mutex _mutex;
+
+public:
+    DayClustering(Simulation *setup, IrishData *irishData, int startHouse, int houses, double powerFactor = 1.0);
+    ~DayClustering();
+
+    void setClusters(int clusters);
+    void setThreads(int threads);
+
+    // Clusters the days, solves all of them and compares the results.
+    // Returns false if there are fewer days than clusters or a day can not
+    // be solved
+    bool run();
+
+    // Writes the clusters and the comparison as CSV
+    bool save(string path);
+
+    // Medoid day of a cluster and the number of days it stands for
+    int getMedoid(int cluster);
+    int getWeight(int cluster);
+
+    // Squared Euclidean distance of two shapes, with independent partial
+    // sums the compiler can vectorise
+    static double squaredDistance(const double *first, const double *second, size_t length);
+
+protected:
+    // Builds the shapes of all complete days
+    void buildShapes();
+
+    // Assigns a range of days to their nearest medoid, run on worker threads
+    void assignDays(int first, int last, int *moved);
+
+    // Solves a range of days, run on worker threads
+    void solveDays(int worker, int first, int last);
+
+    // Sums the results of several days with the given weights
+    dayMetrics combine(const vector<int> &days, const vector<int> &weights);
+};
+
+#endif /* defined(__DiCOMO__dayClustering__) */
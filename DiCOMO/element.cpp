@@ -8,21 +8,20 @@
 
 #include "element.h"
 
-long numberOfElements = 0;
+// Atomic so that circuits may be assembled on several threads at once
+#include <atomic>
+
+atomic<long> numberOfElements(0);
 
 #pragma mark PUBLIC
 
 Element::Element(complex<double> vcc, complex<double> vss) {
-    // Assign element index number
-    _elementIndex = numberOfElements;
+    // Assign element index number and increase global element count by one
+    _elementIndex = numberOfElements++;
     
     // Assign source (vcc) and sink (vss) to element
     _vcc = vcc;
     _vss = vss;
-    
-    // Increase global element count by one
-    // Since element has now been generated successfully
-    numberOfElements++;
 }
 
 Element::~Element() {
@@ -34,13 +33,10 @@ Element::~Element() {
 string Element::elementName() {
     // Creates a string that starts with the element's type
     // And appends the element's index
-    stringstream elementNameStream;
-    
-    // This has to be outputted to a stream...
-    elementNameStream << _elementType << "_" << _elementIndex;
+    char index[24];
+    snprintf(index, sizeof(index), "_%ld", _elementIndex);
     
-    // ... before it is appended to the name string
-    return elementNameStream.str();
+    return _elementType + index;
 }
 
 int Element::connectTo(Element *neighbour, string mine, string his) {
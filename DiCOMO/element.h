@@ -39,7 +39,7 @@ public:
     Element(complex<double> vcc, complex<double> vss);
     
     // Destructor
-    ~Element();
+    virtual ~Element();
 
     // Returns the element name
     string elementName();
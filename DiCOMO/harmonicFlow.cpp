@@ -0,0 +1,275 @@
+//
+//  harmonicFlow.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "harmonicFlow.h"
+
+// Typical spectrum of a mix of electronic loads, relative to the
+// fundamental current
+static const int typicalOrders[] = {3, 5, 7, 9, 11, 13, 15, 17, 19};
+static const double typicalMagnitudes[] = {0.20, 0.12, 0.07, 0.04, 0.03, 0.02, 0.01, 0.01, 0.01};
+
+HarmonicFlow::HarmonicFlow() {
+    _connections = 0;
+    _threads = 1;
+    _time = 0.0;
+}
+
+void HarmonicFlow::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+bool HarmonicFlow::loadSpectra(string path) {
+    ifstream input(path.c_str());
+    if (!input.is_open()) {
+        cout << "ERROR : Could not open <" << path << ">." << endl;
+        return false;
+    }
+
+    // Rows that do not start with numbers, like a header, are skipped
+    int rows = 0;
+    string line;
+    while (getline(input, line)) {
+        int connection, order;
+        double magnitude, angle;
+        if (sscanf(line.c_str(), "%d,%d,%lf,%lf", &connection, &order, &magnitude, &angle) != 4)
+            continue;
+        if (connection < 0 || order < 2 || order > HARMONIC_ORDERS) {
+            cout << "ERROR : Ignoring order <" << order << "> of connection <" << connection << ">" << endl;
+            continue;
+        }
+
+        if (_spectra.size() <= connection)
+            _spectra.resize(connection + 1);
+        if (_spectra[connection].empty())
+            _spectra[connection].assign(HARMONIC_ORDERS + 1, 0.0);
+        _spectra[connection][order] = polar(magnitude, angle * M_PI / 180.0);
+        rows++;
+    }
+
+    if (rows == 0) {
+        cout << "ERROR : <" << path << "> contains no spectra." << endl;
+        return false;
+    }
+    return true;
+}
+
+bool HarmonicFlow::compute(Simulation *simulation) {
+    if (!simulation->hasConverged()) {
+        cout << "ERROR : Harmonics need a solved operating point." << endl;
+        return false;
+    }
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    size_t n = simulation->getConnectionCount();
+    if (n == 0 || impedances.size() != n * 3) {
+        cout << "ERROR : Harmonics need an assembled circuit." << endl;
+        return false;
+    }
+    if (_spectra.size() > n)
+        cout << "ERROR : Ignoring the spectra of " << _spectra.size() - n << " connection(s) beyond the feeder" << endl;
+
+    // The return line comes first, then per phase each consumer followed by
+    // its feeder segment
+    vector<size_t> consumerOf(n);
+    vector<long> lastOnPhase(simulation->getPhases(), -1);
+    _previousOnPhase.assign(n, -1);
+    size_t index = n;
+    for (int phase = 1; phase <= simulation->getPhases(); phase++) {
+        for (size_t k = 0; k < n; k++) {
+            if (simulation->getConnectionPhase((int) k) != phase)
+                continue;
+            consumerOf[k] = index;
+            _previousOnPhase[k] = lastOnPhase[phase-1];
+            lastOnPhase[phase-1] = k;
+            index += 2;
+        }
+    }
+
+    _connections = (int) n;
+    _phases.assign(n, 0);
+    _returnImpedances.assign(n, 0.0);
+    _feederImpedances.assign(n, 0.0);
+    _currents.assign(n, 0.0);
+    _voltages.assign(n, 0.0);
+    for (size_t k = 0; k < n; k++) {
+        _phases[k] = simulation->getConnectionPhase((int) k);
+        _returnImpedances[k] = impedances[k];
+        _feederImpedances[k] = impedances[consumerOf[k]+1];
+        _currents[k] = currents[consumerOf[k]];
+        _voltages[k] = abs(leftVoltages[consumerOf[k]] - rightVoltages[consumerOf[k]]);
+    }
+
+    _houseSums.assign(n, 0.0);
+    _returnSums.assign(n, 0.0);
+
+    // Orders are dealt out in turn, so every thread gets low and high ones
+    double startTime = Metrics::now();
+    int threads = min(_threads, HARMONIC_ORDERS - 1);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.push_back(thread(&HarmonicFlow::solveOrders, this, 2 + t, threads));
+    for (int t = 0; t < threads; t++)
+        workers[t].join();
+    _time = Metrics::now() - startTime;
+
+    for (size_t k = 0; k < n; k++) {
+        if (_houseSums[k] != _houseSums[k]) {
+            cout << "ERROR : Harmonics could not be solved." << endl;
+            return false;
+        }
+    }
+
+    size_t worst = 0;
+    for (size_t k = 1; k < n; k++)
+        if (getDistortion((int) k) > getDistortion((int) worst))
+            worst = k;
+
+    cout << "Harmonic orders :" << setw(12) << HARMONIC_ORDERS - 1 << " on " << threads << " thread(s) in ";
+    cout << fixed << setprecision(3) << _time * 1000 << " ms" << endl;
+    cout << "Highest THD :" << setw(16) << setprecision(2) << getDistortion((int) worst) << " % at connection " << worst << endl;
+
+    return true;
+}
+
+bool HarmonicFlow::save(string path) {
+    string file = path + "_harmonics.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "Connection,Phase,Fundamental (V),Harmonics (V),THD (%),Return harmonics (V)" << endl;
+    for (int k = 0; k < _connections; k++) {
+        output << k << "," << _phases[k] << "," << setprecision(10) << _voltages[k] << ",";
+        output << sqrt(_houseSums[k]) << "," << getDistortion(k) << "," << sqrt(_returnSums[k]) << endl;
+    }
+    output.close();
+
+    cout << " File successfully written to:" << endl << file << endl;
+    return true;
+}
+
+double HarmonicFlow::getDistortion(int connection) {
+    if (connection < 0 || connection >= _connections || _voltages[connection] == 0.0)
+        return NAN;
+    return 100.0 * sqrt(_houseSums[connection]) / _voltages[connection];
+}
+
+double HarmonicFlow::resistanceFactor(int order) {
+    double squared = (double) order * order;
+    return 1.0 + 0.646 * squared / (192.0 + 0.518 * squared);
+}
+
+#pragma mark PROTECTED
+
+void HarmonicFlow::solveOrders(int firstOrder, int step) {
+    typedef complex<long double> complexLong;
+
+    size_t n = _connections;
+    size_t band = 2;
+    for (size_t k = 0; k < n; k++)
+        if (_previousOnPhase[k] >= 0)
+            band = max(band, (size_t)(2*k+1 - (2*_previousOnPhase[k]+1)));
+
+    size_t nodes = 2 * n;
+    size_t width = 2 * band + 1;
+    vector<double> houseSums(n, 0.0), returnSums(n, 0.0);
+
+    for (int order = firstOrder; order <= HARMONIC_ORDERS; order += step) {
+        vector<complexLong> matrix(nodes * width, 0.0L);
+        vector<complexLong> injections(nodes, 0.0L);
+        bool drawn = false;
+
+        // Sources and sink are short circuits at this order, so they only
+        // add to the diagonal
+        for (size_t k = 0; k < n; k++) {
+            size_t returnNode = 2*k;
+            size_t feederNode = 2*k + 1;
+
+            complex<double> impedance(_returnImpedances[k].real() * resistanceFactor(order), _returnImpedances[k].imag() * order);
+            complexLong admittance = 1.0L / ((abs(impedance) != 0) ? complexLong(impedance.real(), impedance.imag()) : 1e-12L);
+            matrix[returnNode*width + band] += admittance;
+            if (k > 0) {
+                matrix[(returnNode-2)*width + band] += admittance;
+                matrix[returnNode*width + band-2] -= admittance;
+                matrix[(returnNode-2)*width + band+2] -= admittance;
+            }
+
+            impedance = complex<double>(_feederImpedances[k].real() * resistanceFactor(order), _feederImpedances[k].imag() * order);
+            admittance = 1.0L / ((abs(impedance) != 0) ? complexLong(impedance.real(), impedance.imag()) : 1e-12L);
+            matrix[feederNode*width + band] += admittance;
+            if (_previousOnPhase[k] >= 0) {
+                size_t previous = 2*_previousOnPhase[k] + 1;
+                size_t distance = feederNode - previous;
+                matrix[previous*width + band] += admittance;
+                matrix[feederNode*width + band-distance] -= admittance;
+                matrix[previous*width + band+distance] -= admittance;
+            }
+
+            // The house draws its harmonic current from the feeder into the
+            // return line
+            complex<double> current = harmonicCurrent((int) k, order);
+            injections[feederNode] -= complexLong(current.real(), current.imag());
+            injections[returnNode] += complexLong(current.real(), current.imag());
+            drawn = drawn || (abs(current) != 0.0);
+        }
+
+        if (!drawn)
+            continue;
+
+        // Gaussian elimination within the band. The matrix is diagonally
+        // dominant, so no pivoting is needed
+        for (size_t i = 0; i < nodes; i++) {
+            complexLong pivot = matrix[i*width + band];
+            for (size_t j = i+1; j <= min(nodes-1, i+band); j++) {
+                complexLong factor = matrix[j*width + i-j+band] / pivot;
+                if (factor == 0.0L)
+                    continue;
+                for (size_t c = i; c <= min(nodes-1, i+band); c++)
+                    matrix[j*width + c-j+band] -= factor * matrix[i*width + c-i+band];
+                injections[j] -= factor * injections[i];
+            }
+        }
+
+        vector<complexLong> voltages(nodes);
+        for (size_t i = nodes; i-- > 0;) {
+            complexLong sum = injections[i];
+            for (size_t c = i+1; c <= min(nodes-1, i+band); c++)
+                sum -= matrix[i*width + c-i+band] * voltages[c];
+            voltages[i] = sum / matrix[i*width + band];
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            houseSums[k] += (double) norm(voltages[2*k+1] - voltages[2*k]);
+            returnSums[k] += (double) norm(voltages[2*k]);
+        }
+    }
+
+    lock_guard<mutex> lock(_mutex);
+    for (size_t k = 0; k < n; k++) {
+        _houseSums[k] += houseSums[k];
+        _returnSums[k] += returnSums[k];
+    }
+}
+
+complex<double> HarmonicFlow::harmonicCurrent(int connection, int order) {
+    complex<double> relative = 0.0;
+    if (connection < _spectra.size() && !_spectra[connection].empty()) {
+        relative = _spectra[connection][order];
+    } else {
+        for (size_t i = 0; i < sizeof(typicalOrders) / sizeof(int); i++)
+            if (typicalOrders[i] == order)
+                relative = typicalMagnitudes[i];
+    }
+
+    // The spectrum turns with the fundamental, h times as fast
+    return abs(_currents[connection]) * relative * polar(1.0, order * arg(_currents[connection]));
+}
@@ -0,0 +1,100 @@
+//
+//  harmonicFlow.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__harmonicFlow__
+#define __DiCOMO__harmonicFlow__
+
+//  Harmonic voltages along a feeder, from a solved operating point. Every
+//  consumer draws, on top of its fundamental current I_1, a harmonic current
+//  of each order h given by its spectrum relative to the fundamental:
+//
+//      I_h = |I_1| m_h exp(j (h arg(I_1) + phi_h))
+//
+//  so the triplen harmonics of the phases add up in the return line. The
+//  sources and the sink are ideal, so they are short circuits for h > 1, and
+//  the segments are scaled per order: X_h = h X and R_h follows the usual
+//  approximation of the skin effect. Each order is then one linear banded
+//  nodal solve that does not depend on any other, so the orders are spread
+//  over the threads. The voltage across every house combines into its THD.
+//
+//  Spectra are read from a CSV file with one row per house and order:
+//
+//      connection, order, magnitude (of the fundamental current), angle (deg)
+//
+//  Houses without a row in the file draw a typical spectrum of a mix of
+//  electronic loads.
+
+#include "simulation.h"
+
+#include <thread>
+#include <mutex>
+
+// Highest harmonic order solved
+#define HARMONIC_ORDERS         50
+
+class HarmonicFlow {
+protected:
+    int _connections;
+    int _threads;
+
+    // Phase, previous connection on its phase and segments at the
+    // fundamental of every connection
+    vector<int> _phases;
+    vector<long> _previousOnPhase;
+    vector< complex<double> > _returnImpedances;
+    vector< complex<double> > _feederImpedances;
+
+    // Fundamental current drawn and voltage across every house
+    vector< complex<double> > _currents;
+    vector<double> _voltages;
+
+    // Spectrum of every house relative to its fundamental current, indexed
+    // by order. Empty for the typical one
+    vector< vector< complex<double> > > _spectra;
+
+    // Sums of the squared harmonic voltages across every house and of its
+    // return node, over all orders
+    vector<double> _houseSums;
+    vector<double> _returnSums;
+
+    // Time of all orders in s
+    double _time;
+
+    mutex _mutex;
+
+public:
+    HarmonicFlow();
+
+    void setThreads(int threads);
+
+    // Reads the spectra of the houses from a CSV file
+    bool loadSpectra(string path);
+
+    // Solves all orders at the current solution of the simulation
+    bool compute(Simulation *simulation);
+
+    // Writes the THD of every house as CSV
+    bool save(string path);
+
+    // THD of the voltage across a house in percent
+    double getDistortion(int connection);
+
+    // Resistance of a segment at the given order relative to that at the
+    // fundamental
+    static double resistanceFactor(int order);
+
+protected:
+    // Solves every order from the first in steps of the given size, run on
+    // worker threads
+    void solveOrders(int firstOrder, int step);
+
+    // Harmonic current drawn by a house at the given order
+    complex<double> harmonicCurrent(int connection, int order);
+};
+
+#endif /* defined(__DiCOMO__harmonicFlow__) */
@@ -0,0 +1,233 @@
+//
+//  hostingCapacity.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "hostingCapacity.h"
+
+HostingCapacity::HostingCapacity(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor) {
+    _setup = setup;
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _houses = houses;
+    _firstSample = firstSample;
+    _samples = max(1, samples);
+    _powerFactor = powerFactor;
+
+    _mode = PerHouseHosting;
+    _threads = 1;
+    _limit = 0.0;
+}
+
+HostingCapacity::~HostingCapacity() {
+    while (!_workers.empty()) {
+        delete _workers.back();
+        _workers.pop_back();
+    }
+}
+
+void HostingCapacity::setMode(int mode) {
+    if (mode < 0 || mode >= NumberOfHostingModes) {
+        cout << "ERROR : Unknown hosting capacity mode <" << mode << ">" << endl;
+        return;
+    }
+    _mode = mode;
+}
+
+void HostingCapacity::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+void HostingCapacity::setLimit(double limit) {
+    _limit = max(0.0, limit);
+}
+
+bool HostingCapacity::run() {
+    if (_limit == 0.0)
+        _limit = HOSTING_LIMIT * abs(_setup->getSource() - _setup->getSink());
+
+    // Uniform searches are a single bisection
+    int threads = (_mode == UniformHosting) ? 1 : min(_threads, _houses);
+    for (int i = (int) _workers.size(); i < threads; i++) {
+        _workers.push_back(new Simulation(_setup));
+        _workers.back()->setSolver(ReferenceSolver);
+    }
+
+    _capacities.assign(_mode == UniformHosting ? 1 : _houses, HOSTING_MAXIMUM);
+
+    cout << "Hosting capacity of " << _houses << " houses (" << modeName(_mode) << ") over ";
+    cout << _samples << " sample(s) up to " << fixed << setprecision(1) << _limit << " V on " << threads << " thread(s)" << endl;
+
+    // Consecutive blocks of positions per thread
+    vector<thread> searches;
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        int count = (_mode == UniformHosting) ? 0 : _houses / threads + (t < _houses % threads ? 1 : 0);
+        searches.push_back(thread(&HostingCapacity::searchPositions, this, t, first, first + count));
+        first += count;
+    }
+    for (int t = 0; t < threads; t++)
+        searches[t].join();
+
+    for (size_t i = 0; i < _capacities.size(); i++) {
+        if (_capacities[i] != _capacities[i]) {
+            cout << "ERROR : Feeder could not be solved under the sample loads." << endl;
+            return false;
+        }
+    }
+
+    double lowest = *min_element(_capacities.begin(), _capacities.end());
+    double highest = *max_element(_capacities.begin(), _capacities.end());
+    cout << "Capacity :" << setw(16) << setprecision(0) << (lowest >= HOSTING_MAXIMUM ? ">=" : "") << lowest << " W";
+    if (_mode == PerHouseHosting)
+        cout << " to " << (highest >= HOSTING_MAXIMUM ? ">=" : "") << highest << " W";
+    cout << endl;
+
+    return true;
+}
+
+bool HostingCapacity::save(string path) {
+    string file = path + "_hosting.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    // Capped capacities are only known to be at least the largest export
+    output << "House,Phase,Capacity (W)" << endl;
+    if (_mode == UniformHosting) {
+        output << "all,all," << (_capacities[0] >= HOSTING_MAXIMUM ? ">=" : "") << _capacities[0] << endl;
+    } else {
+        for (size_t i = 0; i < _capacities.size(); i++) {
+            output << _startHouse + i << "," << _workers[0]->getConnectionPhase((int) i) << ",";
+            output << (_capacities[i] >= HOSTING_MAXIMUM ? ">=" : "") << _capacities[i] << endl;
+        }
+    }
+    output.close();
+
+    cout << " File successfully written to:" << endl << file << endl;
+    return true;
+}
+
+const char *HostingCapacity::modeName(int mode) {
+    switch (mode) {
+        case PerHouseHosting:   return "house";
+        case UniformHosting:    return "uniform";
+        default:                return "unknown";
+    }
+}
+
+int HostingCapacity::parseMode(string text) {
+    for (int mode = 0; mode < NumberOfHostingModes; mode++)
+        if (text == modeName(mode))
+            return mode;
+    return -1;
+}
+
+#pragma mark PROTECTED
+
+void HostingCapacity::searchPositions(int worker, int first, int last) {
+    Simulation *simulation = _workers[worker];
+    vector< complex<double> > loads;
+
+    for (int sample = _firstSample; sample < _firstSample + _samples; sample++) {
+        if (!applySample(simulation, sample, loads)) {
+            for (int i = first; i < max(last, first + 1) && i < _capacities.size(); i++)
+                _capacities[i] = NAN;
+            return;
+        }
+
+        // The capacity is the lowest under any of the samples
+        if (_mode == UniformHosting) {
+            _capacities[0] = min(_capacities[0], bisect(simulation, loads, -1));
+            continue;
+        }
+        for (int position = first; position < last; position++)
+            _capacities[position] = min(_capacities[position], bisect(simulation, loads, position));
+    }
+}
+
+bool HostingCapacity::applySample(Simulation *simulation, int sample, vector< complex<double> > &loads) {
+    simulation->clearPowers();
+    for (int i = 0; i < _houses; i++)
+        simulation->addPowerToPhase(_irishData->getSampleForHouse(sample, _startHouse + i), _powerFactor, (i % simulation->getPhases()) + 1);
+
+    // The circuit is only assembled for the first sample
+    if (!simulation->updatePowers()) {
+        if (!simulation->validate())
+            return false;
+        simulation->assemble();
+    }
+
+    // The operating point is solved in full, only the probes may stop early
+    simulation->setVoltageCeiling(0.0);
+    simulation->solve();
+    simulation->setVoltageCeiling(_limit);
+
+    loads.clear();
+    for (int i = 0; i < _houses; i++)
+        loads.push_back(simulation->getConnectionPower(i));
+
+    return simulation->hasConverged();
+}
+
+double HostingCapacity::bisect(Simulation *simulation, vector< complex<double> > &loads, int position) {
+    double lower = 0.0;
+    double upper = HOSTING_START;
+
+    // Double the export from the operating point until the limit is passed,
+    // so no probe is far beyond the capacity
+    if (!isWithinLimit(simulation, loads, position, lower)) {
+        upper = 0.0;
+    } else {
+        while (isWithinLimit(simulation, loads, position, upper)) {
+            lower = upper;
+            if (upper >= HOSTING_MAXIMUM)
+                break;
+            upper = min(2.0 * upper, HOSTING_MAXIMUM);
+        }
+    }
+
+    while (upper - lower > HOSTING_RESOLUTION) {
+        double middle = 0.5 * (lower + upper);
+        if (isWithinLimit(simulation, loads, position, middle))
+            lower = middle;
+        else
+            upper = middle;
+    }
+
+    // Leave the loads of the sample for the next position
+    for (int i = 0; i < _houses; i++)
+        simulation->setConnectionPower(i, loads[i]);
+
+    return lower;
+}
+
+bool HostingCapacity::isWithinLimit(Simulation *simulation, vector< complex<double> > &loads, int position, double injection) {
+    // Only the exporting houses change, bisect restores the loads afterwards
+    if (position < 0) {
+        for (int i = 0; i < _houses; i++)
+            simulation->setConnectionPower(i, loads[i] - injection);
+    } else {
+        simulation->setConnectionPower(position, loads[position] - injection);
+    }
+    simulation->updatePowers();
+    simulation->solve();
+
+    if (!simulation->hasConverged())
+        return false;
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    // Consumers follow the return line, each followed by its feeder segment
+    for (size_t i = _houses; i < leftVoltages.size(); i += 2)
+        if (abs(leftVoltages[i] - rightVoltages[i]) > _limit)
+            return false;
+
+    return true;
+}
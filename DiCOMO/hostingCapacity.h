@@ -0,0 +1,107 @@
+//
+//  hostingCapacity.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__hostingCapacity__
+#define __DiCOMO__hostingCapacity__
+
+//  Hosting capacity of rooftop PV along a feeder. For every house, or for all
+//  houses at once, the exported real power is doubled from a small export
+//  until the highest voltage at any house passes its limit, and then bisected
+//  between the last two exports. The search runs under the loads of a set of
+//  Irish data samples and the capacity is the lowest over them. Exports that
+//  keep the limit up to HOSTING_MAXIMUM are reported as capped.
+//
+//  Export is modelled as a consumer of negative real power, which only the
+//  reference solver supports. Each thread keeps its own simulation whose
+//  circuit is assembled once. A probe only changes the power of the exporting
+//  houses, and every solve starts from the solution of the previous probe.
+//  A probe stops as soon as its voltage settles above the limit or diverges,
+//  so probes past voltage collapse do not run all reference iterations.
+
+#include "simulation.h"
+#include "irishData.h"
+
+#include <thread>
+
+// Default voltage limit relative to the nominal voltage
+#define HOSTING_LIMIT           1.10
+
+// First export probed, largest export searched and the resolution of the
+// bisection in W
+#define HOSTING_START           1000.0
+#define HOSTING_MAXIMUM         100000.0
+#define HOSTING_RESOLUTION      10.0
+
+enum hostingMode {
+    PerHouseHosting         = 0,    // every house exports on its own
+    UniformHosting          = 1,    // all houses export the same power
+    NumberOfHostingModes    = 2,
+};
+
+class HostingCapacity {
+protected:
+    // Feeder and return impedances and voltages. Its powers are replaced by
+    // the samples
+    Simulation *_setup;
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _houses;
+    int _firstSample;
+    int _samples;
+    double _powerFactor;
+
+    int _mode;
+    int _threads;
+
+    // Highest voltage allowed at any house in V
+    double _limit;
+
+    // One simulation per thread
+    vector<Simulation *> _workers;
+
+    // Capacity of each house in W, a single one if uniform. HOSTING_MAXIMUM
+    // if the limit was not reached
+    vector<double> _capacities;
+
+public:
+    HostingCapacity(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor = 1.0);
+    ~HostingCapacity();
+
+    void setMode(int mode);
+    void setThreads(int threads);
+    // Zero keeps the default of HOSTING_LIMIT times the nominal voltage
+    void setLimit(double limit);
+
+    // Runs the search. Returns false if the feeder can not be solved
+    bool run();
+
+    // Writes the capacity of every house (or of all) as CSV
+    bool save(string path);
+
+    static const char *modeName(int mode);
+    // Returns -1 if unknown
+    static int parseMode(string text);
+
+protected:
+    // Searches the capacities of the given range of positions, run on
+    // worker threads. Uniform searches pass the range 0 to 0
+    void searchPositions(int worker, int first, int last);
+
+    // Sets a simulation up with the loads of a sample and solves them
+    bool applySample(Simulation *simulation, int sample, vector< complex<double> > &loads);
+
+    // Brackets and bisects the export of a position, or of all if position
+    // is -1
+    double bisect(Simulation *simulation, vector< complex<double> > &loads, int position);
+
+    // Solves with the given export (injection in W) and checks the limit
+    bool isWithinLimit(Simulation *simulation, vector< complex<double> > &loads, int position, double injection);
+};
+
+#endif /* defined(__DiCOMO__hostingCapacity__) */
@@ -8,10 +8,16 @@
 
 #include "irishData.h"
 
-IrishData::IrishData(string path, bool inColumns, unsigned char cols, unsigned char rows, double scale) {
+IrishData::IrishData(string path, bool inColumns, unsigned char cols, unsigned char rows, double scale, double resolution) {
     // Check if the file exists
     _fileExists = false;
     
+    // Default to the exact double representation
+    _storage = DoubleProfiles;
+    _verifyStorage = false;
+    _maxConversionError = 0.0;
+    _clippedSamples = 0;
+    
     ifstream input(path.c_str(), ios::binary);
     if (input.is_open()) {
         input.close();
@@ -22,6 +28,7 @@ IrishData::IrishData(string path, bool inColumns, unsigned char cols, unsigned c
         _ignoireCols = cols;
         _ignoireRows = rows;
         _scale = scale;
+        _resolution = resolution;
         _fileExists = true;
         
     } else {
@@ -38,7 +45,32 @@ IrishData::~IrishData() {
     // Destruct everything
 }
 
+void IrishData::setStorage(profileStorage storage, bool verify) {
+    // The representation can not be changed once the data is in memory
+    if (getStorage() != storage && !(   _powerProfiles.empty()
+                                     && _floatProfiles.empty()
+                                     && _fixed16Profiles.empty()
+                                     && _fixed32Profiles.empty())) {
+        cout << "ERROR : Profile storage must be set before loading the data." << endl;
+        return;
+    }
+    
+    _storage = storage;
+    _verifyStorage = verify;
+}
+
+profileStorage IrishData::getStorage() {
+    return _storage;
+}
+
+double IrishData::getMaxConversionError() {
+    return _maxConversionError;
+}
+
 void IrishData::loadData() {
+    TraceSpan span("load irish data");
+    MemoryStageScope stage(LoadStage);
+    
     // Load the data from the input file
     // Make sure the file exists
     if (!_fileExists) {
@@ -54,6 +86,9 @@ void IrishData::loadData() {
         // Counts the rows that were jumped over to ignore them
         unsigned char rows = 0;
         
+        // Number of houses that have been added to the matrix so far
+        size_t houses = 0;
+        
         while (input.good()) {
             // Buffer that will store the power value read from the datasheet
             vector<double> profile;
@@ -115,42 +150,65 @@ void IrishData::loadData() {
             if (_profilesInColumn) {
                 
                 // Check if matrix is empty
-                if (_powerProfiles.empty()) {
+                if (houses == 0) {
                     // If it is, then insert the 
                     for (int i = 0; i < profile.size(); i++) {
-                        vector<double> emptyVector;
-                        _powerProfiles.push_back(emptyVector);
+                        addHouse();
                     }
+                    houses = profile.size();
                 }
                 
                 // Then append each power value to the individual houses
-                for (int i = 0; i < profile.size(); i++) {
-                    _powerProfiles[i].push_back(profile[i]);
+                for (int i = 0; i < profile.size() && i < houses; i++) {
+                    appendSample(i, profile[i]);
                 }
                 
-            } else {
+            } else if (!profile.empty()) {
                 // If each row contains a house's power profile,
-                // simply insert it into the vector
-                _powerProfiles.push_back(profile);
+                // simply insert it into the matrix
+                addHouse();
+                for (int i = 0; i < profile.size(); i++) {
+                    appendSample(houses, profile[i]);
+                }
+                houses++;
             }
         }
         
         input.close();
+        
+        if (_verifyStorage) {
+            cout << "Max. conversion error :" << setw(30) << _maxConversionError << " W" << endl;
+            cout << "Clipped samples :" << setw(36) << _clippedSamples << endl;
+        }
     }
 }
 
 dataSize IrishData::getDataSize() {
     dataSize size;
     
-    // Make sure the matrix is not empty
-    if (_powerProfiles.empty()) {
-        cout << "ERROR : No data has been read in yet." << endl;
-        return size;
+    // Get sizes from the matrix that is in use
+    switch (_storage) {
+        case FloatProfiles:
+            size.houses = _floatProfiles.size();
+            size.samples = size.houses ? _floatProfiles[0].size() : 0;
+            break;
+        case Fixed16Profiles:
+            size.houses = _fixed16Profiles.size();
+            size.samples = size.houses ? _fixed16Profiles[0].size() : 0;
+            break;
+        case Fixed32Profiles:
+            size.houses = _fixed32Profiles.size();
+            size.samples = size.houses ? _fixed32Profiles[0].size() : 0;
+            break;
+        default:
+            size.houses = _powerProfiles.size();
+            size.samples = size.houses ? _powerProfiles[0].size() : 0;
+            break;
     }
     
-    // Get sizes from matrix and return the values
-    size.houses = _powerProfiles.size();
-    size.samples = _powerProfiles[0].size();
+    // Make sure the matrix is not empty
+    if (size.houses == 0)
+        cout << "ERROR : No data has been read in yet." << endl;
     
     return size;
 }
@@ -163,7 +221,46 @@ double IrishData::getSampleForHouse(int delay, int house) {
         return 0;
     }
     
-    return _powerProfiles[house][delay];
+    return sampleAt(house, delay);
+}
+
+powerMoments IrishData::getMomentsForHouse(int house, int timeOfDay, int samplesPerDay) {
+    powerMoments moments;
+    memset(&moments, 0, sizeof(powerMoments));
+    
+    dataSize maximumSize = getDataSize();
+    if (house >= maximumSize.houses || timeOfDay < 0 || timeOfDay >= samplesPerDay) {
+        cout << "ERROR : Data is out of the matrix bounds." << endl;
+        return moments;
+    }
+    
+    for (size_t delay = timeOfDay; delay < maximumSize.samples; delay += samplesPerDay) {
+        moments.mean += sampleAt(house, delay);
+        moments.days++;
+    }
+    if (moments.days == 0)
+        return moments;
+    moments.mean /= moments.days;
+    
+    // Central moments around the mean
+    double second = 0.0, third = 0.0, fourth = 0.0;
+    for (size_t delay = timeOfDay; delay < maximumSize.samples; delay += samplesPerDay) {
+        double difference = sampleAt(house, delay) - moments.mean;
+        second += difference * difference;
+        third += difference * difference * difference;
+        fourth += difference * difference * difference * difference;
+    }
+    second /= moments.days;
+    third /= moments.days;
+    fourth /= moments.days;
+    
+    moments.deviation = sqrt(second);
+    if (second > 0.0) {
+        moments.skewness = third / pow(second, 1.5);
+        moments.kurtosis = fourth / (second * second);
+    }
+    
+    return moments;
 }
 
 void IrishData::applyProfilesToSim(Simulation *simulation, int startHouse, int houseCount, int delay, double powerFactor, int phases) {
@@ -177,7 +274,84 @@ void IrishData::applyProfilesToSim(Simulation *simulation, int startHouse, int h
     }
     
     for (int i = 0; i < houseCount; i++) {
-        simulation->addPowerToPhase(_powerProfiles[startHouse+i][delay], powerFactor, (i%phases)+1);
+        simulation->addPowerToPhase(sampleAt(startHouse+i, delay), powerFactor, (i%phases)+1);
+    }
+}
+
+#pragma mark PROTECTED
+
+void IrishData::addHouse() {
+    switch (_storage) {
+        case FloatProfiles:
+            _floatProfiles.push_back(vector<float>());
+            break;
+        case Fixed16Profiles:
+            _fixed16Profiles.push_back(vector<int16_t>());
+            break;
+        case Fixed32Profiles:
+            _fixed32Profiles.push_back(vector<int32_t>());
+            break;
+        default:
+            _powerProfiles.push_back(vector<double>());
+            break;
+    }
+}
+
+void IrishData::appendSample(size_t house, double value) {
+    // The fixed-point representations store the number of resolution steps
+    // while the step size itself is only stored once in _scale * _resolution
+    double step = _scale * _resolution;
+    double steps = floor(value / step + 0.5);
+    
+    // The value as it will be read back
+    double stored = value;
+    
+    switch (_storage) {
+        case FloatProfiles:
+            _floatProfiles[house].push_back((float)value);
+            stored = _floatProfiles[house].back();
+            break;
+            
+        case Fixed16Profiles:
+            // Clip values that do not fit into 16 bit
+            if (steps > INT16_MAX || steps < INT16_MIN) {
+                steps = (steps > 0) ? INT16_MAX : INT16_MIN;
+                _clippedSamples++;
+            }
+            _fixed16Profiles[house].push_back((int16_t)steps);
+            stored = _fixed16Profiles[house].back() * step;
+            break;
+            
+        case Fixed32Profiles:
+            // Clip values that do not fit into 32 bit
+            if (steps > INT32_MAX || steps < INT32_MIN) {
+                steps = (steps > 0) ? INT32_MAX : INT32_MIN;
+                _clippedSamples++;
+            }
+            _fixed32Profiles[house].push_back((int32_t)steps);
+            stored = _fixed32Profiles[house].back() * step;
+            break;
+            
+        default:
+            _powerProfiles[house].push_back(value);
+            break;
+    }
+    
+    // Compare the widened value against the exact one
+    if (_verifyStorage && fabs(stored - value) > _maxConversionError)
+        _maxConversionError = fabs(stored - value);
+}
+
+double IrishData::sampleAt(size_t house, size_t delay) {
+    switch (_storage) {
+        case FloatProfiles:
+            return _floatProfiles[house][delay];
+        case Fixed16Profiles:
+            return _fixed16Profiles[house][delay] * _scale * _resolution;
+        case Fixed32Profiles:
+            return _fixed32Profiles[house][delay] * _scale * _resolution;
+        default:
+            return _powerProfiles[house][delay];
     }
 }
 
@@ -11,11 +11,36 @@
 
 #include "simulation.h"
 
+// Fixed width integers for the fixed-point profile storage
+#include <stdint.h>
+
 struct dataSize {
     size_t houses;
     size_t samples;
 };
 
+// Samples of a day, the data set is recorded every half hour
+#define IRISH_SAMPLES_PER_DAY   48
+
+// Distribution of the power of a house at one time of day over all days
+struct powerMoments {
+    double mean;            // in W
+    double deviation;       // in W
+    double skewness;
+    double kurtosis;        // 3 for a normal distribution
+    int days;
+};
+
+// Ways in which the power profiles can be kept in memory. Every value is
+// widened back to a double when it is read, so the rest of the simulation is
+// unaware of the representation chosen
+enum profileStorage {
+    DoubleProfiles  = 0,
+    FloatProfiles   = 1,
+    Fixed16Profiles = 2,
+    Fixed32Profiles = 3,
+};
+
 class IrishData {
     // The path to the data
     string _pathToData;
@@ -32,15 +57,40 @@ class IrishData {
     // ALWAYS 2000 becasue: Each sample is in kWh and recorded over 0.5h.
     double _scale;
     
+    // The resolution of the data set. Each sample is given in steps of
+    // 0.001kWh, which makes the fixed-point step equal to _scale * 0.001
+    double _resolution;
+    
     bool _fileExists;
     
+    // Representation in which the profiles are kept once loaded
+    profileStorage _storage;
+    
+    // Whether the conversion error against the double values is tracked
+    bool _verifyStorage;
+    double _maxConversionError;
+    long _clippedSamples;
+    
     // Matrix where each row contains a vector of each house's power profile
+    // Only the matrix that matches _storage is filled
     vector< vector<double> > _powerProfiles;
+    vector< vector<float> > _floatProfiles;
+    vector< vector<int16_t> > _fixed16Profiles;
+    vector< vector<int32_t> > _fixed32Profiles;
     
 public:
-    IrishData(string path, bool inColumns = true, unsigned char cols = 2, unsigned char rows = 3, double scale = 2000);
+    IrishData(string path, bool inColumns = true, unsigned char cols = 2, unsigned char rows = 3, double scale = 2000, double resolution = 0.001);
     ~IrishData();
     
+    // Chooses the in-memory representation of the profiles. Must be called
+    // before the data is loaded. With verify set, the largest difference
+    // between the stored and the exact double values is reported after loading
+    void setStorage(profileStorage storage, bool verify = false);
+    profileStorage getStorage();
+    
+    // Returns the largest conversion error in W seen while loading
+    double getMaxConversionError();
+    
     // Method that extracts the data from the file and stores it in a matrix
     void loadData();
     // Returns size of the matrix to ensure only valid houses and power profiles
@@ -50,8 +100,23 @@ public:
     // specific sample delay
     double getSampleForHouse(int delay, int house);
     
+    // Moments of the power of a house at a time of day (the sample within a
+    // day) over all days of the data
+    powerMoments getMomentsForHouse(int house, int timeOfDay, int samplesPerDay = IRISH_SAMPLES_PER_DAY);
+    
     // Functions that apply the power profiles to a "DiCOMO" simulation
     void applyProfilesToSim(Simulation *simulation, int startHouse, int houseCount, int delay, double powerFactor = 1.0, int phases = 1);
+    
+protected:
+    // Adds an empty profile for a further house
+    void addHouse();
+    
+    // Converts a value into the chosen representation and appends it to
+    // the profile of a house
+    void appendSample(size_t house, double value);
+    
+    // Widens a stored value back to a double without any bounds checks
+    double sampleAt(size_t house, size_t delay);
 };
 
 
@@ -0,0 +1,319 @@
+//
+//  loadDiversity.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "loadDiversity.h"
+
+LoadDiversity::LoadDiversity(IrishData *irishData, int startHouse, int groupSize, int firstSample, int samples) {
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _groupSize = groupSize;
+    _firstSample = firstSample;
+    _samples = samples;
+    _houses = 0;
+
+    _randomGroups = 0;
+    _threads = 1;
+    _time = 0.0;
+}
+
+void LoadDiversity::setRandomGroups(int groups) {
+    _randomGroups = max(0, groups);
+}
+
+void LoadDiversity::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+bool LoadDiversity::run() {
+    if (!loadProfiles())
+        return false;
+
+    drawGroups();
+
+    int blocks = _houses - _groupSize + 1;
+    int groups = blocks + _randomGroups;
+    _groups.assign(groups, groupDiversity());
+
+    // Every group only reads the shared sums, so any split over the threads
+    // gives the same results
+    double startTime = Metrics::now();
+    int threads = min(_threads, groups);
+    vector<thread> workers;
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        int count = groups / threads + (t < groups % threads ? 1 : 0);
+        workers.push_back(thread(&LoadDiversity::computeGroups, this, first, first + count));
+        first += count;
+    }
+    for (int t = 0; t < threads; t++)
+        workers[t].join();
+    correlateBlock();
+    _time = Metrics::now() - startTime;
+
+    double lowest = INFINITY, highest = 0.0, randomSum = 0.0;
+    for (int g = 0; g < blocks; g++) {
+        lowest = min(lowest, getDiversity(g));
+        highest = max(highest, getDiversity(g));
+    }
+    for (int g = blocks; g < groups; g++)
+        randomSum += getDiversity(g);
+
+    groupDiversity &selected = _groups[_startHouse];
+    cout << "Groups :" << setw(21) << groups << " of " << _groupSize << " houses over " << _samples << " samples in ";
+    cout << fixed << setprecision(3) << _time * 1000 << " ms" << endl;
+    cout << "Block diversity :" << setw(12) << setprecision(3) << lowest << " to " << highest << endl;
+    if (_randomGroups > 0)
+        cout << "Random diversity :" << setw(11) << randomSum / _randomGroups << " on average" << endl;
+    cout << "Selected block :" << setw(13) << getDiversity(_startHouse) << " with a peak of ";
+    cout << setprecision(2) << selected.coincidentPeak / 1000.0 << " kW at sample " << selected.peakSample << endl;
+
+    return true;
+}
+
+bool LoadDiversity::save(string path) {
+    string file = path + "_diversity.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "Group,Houses,Coincident peak (kW),Peak sample,Sum of peaks (kW),Diversity factor,Coincidence factor,Mean correlation" << endl;
+    for (size_t g = 0; g < _groups.size(); g++) {
+        groupDiversity &group = _groups[g];
+        output << g << ",";
+        if (group.first >= 0) {
+            output << group.first << ":" << group.first + _groupSize - 1;
+        } else {
+            vector<int> &members = _members[g - (_houses - _groupSize + 1)];
+            for (size_t i = 0; i < members.size(); i++)
+                output << (i ? " " : "") << members[i];
+        }
+        output << "," << setprecision(10) << group.coincidentPeak / 1000.0 << "," << group.peakSample << ",";
+        output << group.peakSum / 1000.0 << "," << getDiversity((int) g) << ",";
+        output << 1.0 / getDiversity((int) g) << "," << group.correlation << endl;
+    }
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    file = path + "_correlation.csv";
+    output.open(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "House";
+    for (int j = 0; j < _groupSize; j++)
+        output << "," << _startHouse + j;
+    output << endl;
+    for (int i = 0; i < _groupSize; i++) {
+        output << _startHouse + i;
+        for (int j = 0; j < _groupSize; j++)
+            output << "," << _correlations[i*_groupSize + j];
+        output << endl;
+    }
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    return true;
+}
+
+double LoadDiversity::getDiversity(int group) {
+    if (group < 0 || group >= _groups.size() || _groups[group].coincidentPeak <= 0.0)
+        return NAN;
+    return _groups[group].peakSum / _groups[group].coincidentPeak;
+}
+
+void LoadDiversity::seriesStatistics(const double *series, size_t length, double &peak, int &peakSample, double &sum, double &squares) {
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    double squareSums[4] = {0.0, 0.0, 0.0, 0.0};
+    double peaks[4] = {-INFINITY, -INFINITY, -INFINITY, -INFINITY};
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            double value = series[i+lane];
+            sums[lane] += value;
+            squareSums[lane] += value * value;
+            peaks[lane] = max(peaks[lane], value);
+        }
+    }
+    for (; i < length; i++) {
+        sums[0] += series[i];
+        squareSums[0] += series[i] * series[i];
+        peaks[0] = max(peaks[0], series[i]);
+    }
+    sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    squares = (squareSums[0] + squareSums[1]) + (squareSums[2] + squareSums[3]);
+    peak = max(max(peaks[0], peaks[1]), max(peaks[2], peaks[3]));
+
+    // The sample is only searched for once the peak is known
+    peakSample = 0;
+    while (peakSample < length && series[peakSample] != peak)
+        peakSample++;
+}
+
+double LoadDiversity::correlation(const double *first, const double *second, size_t length, double firstMean, double secondMean, double firstDeviation, double secondDeviation) {
+    if (firstDeviation == 0.0 || secondDeviation == 0.0 || length == 0)
+        return NAN;
+
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4)
+        for (int lane = 0; lane < 4; lane++)
+            sums[lane] += (first[i+lane] - firstMean) * (second[i+lane] - secondMean);
+    for (; i < length; i++)
+        sums[0] += (first[i] - firstMean) * (second[i] - secondMean);
+    return ((sums[0] + sums[1]) + (sums[2] + sums[3])) / (length * firstDeviation * secondDeviation);
+}
+
+#pragma mark PROTECTED
+
+bool LoadDiversity::loadProfiles() {
+    dataSize size = _irishData->getDataSize();
+    if (_samples <= 0)
+        _samples = (int) size.samples - _firstSample;
+    if (_firstSample < 0 || _samples <= 0 || _firstSample + _samples > size.samples) {
+        cout << "ERROR : Samples " << _firstSample << " to " << _firstSample + _samples - 1 << " are beyond the data." << endl;
+        return false;
+    }
+    if (_groupSize < 1 || _startHouse < 0 || _startHouse + _groupSize > size.houses) {
+        cout << "ERROR : Houses " << _startHouse << " to " << _startHouse + _groupSize - 1 << " are beyond the data." << endl;
+        return false;
+    }
+
+    _houses = (int) size.houses;
+    size_t length = _samples;
+    _profiles.assign(_houses * length, 0.0);
+    _prefix.assign((_houses + 1) * length, 0.0);
+    _peaks.assign(_houses, 0.0);
+    _deviations.assign(_houses, 0.0);
+    _peakPrefix.assign(_houses + 1, 0.0);
+    _deviationPrefix.assign(_houses + 1, 0.0);
+    _variancePrefix.assign(_houses + 1, 0.0);
+
+    for (int h = 0; h < _houses; h++) {
+        double *profile = &_profiles[h*length];
+        for (size_t t = 0; t < length; t++)
+            profile[t] = _irishData->getSampleForHouse(_firstSample + (int) t, h);
+
+        const double *lower = &_prefix[h*length];
+        double *upper = &_prefix[(h+1)*length];
+        for (size_t t = 0; t < length; t++)
+            upper[t] = lower[t] + profile[t];
+
+        double sum, squares;
+        int peakSample;
+        seriesStatistics(profile, length, _peaks[h], peakSample, sum, squares);
+        double mean = sum / length;
+        double variance = max(0.0, squares / length - mean * mean);
+        _deviations[h] = sqrt(variance);
+
+        _peakPrefix[h+1] = _peakPrefix[h] + _peaks[h];
+        _deviationPrefix[h+1] = _deviationPrefix[h] + _deviations[h];
+        _variancePrefix[h+1] = _variancePrefix[h] + variance;
+    }
+
+    return true;
+}
+
+void LoadDiversity::drawGroups() {
+    // A partial shuffle of all houses for every group
+    srand(DIVERSITY_SEED);
+    vector<int> houses(_houses);
+    _members.assign(_randomGroups, vector<int>());
+    for (int g = 0; g < _randomGroups; g++) {
+        for (int h = 0; h < _houses; h++)
+            houses[h] = h;
+        for (int i = 0; i < _groupSize; i++)
+            swap(houses[i], houses[i + rand() % (_houses - i)]);
+        _members[g].assign(houses.begin(), houses.begin() + _groupSize);
+        sort(_members[g].begin(), _members[g].end());
+    }
+}
+
+void LoadDiversity::computeGroups(int first, int last) {
+    size_t length = _samples;
+    int blocks = _houses - _groupSize + 1;
+    vector<double> series(length);
+
+    for (int g = first; g < last; g++) {
+        groupDiversity &group = _groups[g];
+        double deviationSum = 0.0, varianceSum = 0.0;
+
+        if (g < blocks) {
+            // Summed power of a block from two rows of the prefix sums
+            const double *lower = &_prefix[g*length];
+            const double *upper = &_prefix[(g + _groupSize)*length];
+            for (size_t t = 0; t < length; t++)
+                series[t] = upper[t] - lower[t];
+
+            group.first = g;
+            group.peakSum = _peakPrefix[g + _groupSize] - _peakPrefix[g];
+            deviationSum = _deviationPrefix[g + _groupSize] - _deviationPrefix[g];
+            varianceSum = _variancePrefix[g + _groupSize] - _variancePrefix[g];
+        } else {
+            vector<int> &members = _members[g - blocks];
+            fill(series.begin(), series.end(), 0.0);
+            group.first = -1;
+            group.peakSum = 0.0;
+            for (size_t i = 0; i < members.size(); i++) {
+                const double *profile = &_profiles[members[i]*length];
+                for (size_t t = 0; t < length; t++)
+                    series[t] += profile[t];
+                group.peakSum += _peaks[members[i]];
+                deviationSum += _deviations[members[i]];
+                varianceSum += _deviations[members[i]] * _deviations[members[i]];
+            }
+        }
+
+        double sum, squares;
+        seriesStatistics(&series[0], length, group.coincidentPeak, group.peakSample, sum, squares);
+        group.peakSample += _firstSample;
+        group.correlation = meanCorrelation(sum, squares, deviationSum, varianceSum);
+    }
+}
+
+double LoadDiversity::meanCorrelation(double sum, double squares, double deviationSum, double varianceSum) {
+    double pairs = deviationSum * deviationSum - varianceSum;
+    if (pairs <= 0.0)
+        return NAN;
+
+    double mean = sum / _samples;
+    double variance = squares / _samples - mean * mean;
+    return (variance - varianceSum) / pairs;
+}
+
+void LoadDiversity::correlateBlock() {
+    size_t length = _samples;
+    vector<double> means(_groupSize);
+    for (int i = 0; i < _groupSize; i++) {
+        const double *profile = &_profiles[(_startHouse + i)*length];
+        double sums[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t t = 0;
+        for (; t + 4 <= length; t += 4)
+            for (int lane = 0; lane < 4; lane++)
+                sums[lane] += profile[t+lane];
+        for (; t < length; t++)
+            sums[0] += profile[t];
+        means[i] = ((sums[0] + sums[1]) + (sums[2] + sums[3])) / length;
+    }
+
+    _correlations.assign(_groupSize * _groupSize, 1.0);
+    for (int i = 0; i < _groupSize; i++) {
+        int first = _startHouse + i;
+        if (_deviations[first] == 0.0)
+            _correlations[i*_groupSize + i] = NAN;
+        for (int j = i+1; j < _groupSize; j++) {
+            int second = _startHouse + j;
+            double value = correlation(&_profiles[first*length], &_profiles[second*length], length, means[i], means[j], _deviations[first], _deviations[second]);
+            _correlations[i*_groupSize + j] = value;
+            _correlations[j*_groupSize + i] = value;
+        }
+    }
+}
@@ -0,0 +1,133 @@
+//
+//  loadDiversity.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__loadDiversity__
+#define __DiCOMO__loadDiversity__
+
+//  Coincidence of the power profiles of groups of houses of the Irish data,
+//  to size the transformer feeding them. No circuit is solved. For every
+//  group the summed power over the samples gives its coincident peak, and
+//  against the sum of the individual peaks of its houses
+//
+//      diversity factor   = sum of individual peaks / coincident peak
+//      coincidence factor = 1 / diversity factor
+//
+//  Groups are every block of consecutive houses of the feeder length along
+//  the data, and any number of random groups of the same size. The profiles
+//  are summed once into prefix sums over the houses, so the summed power of
+//  a block is the difference of two rows.
+//
+//  The mean correlation of a group is that of its house pairs weighted by
+//  the product of their standard deviations. It follows from the variance of
+//  the summed power
+//
+//      var(S) = sum sigma_i^2 + rho (sum_i sigma_i)^2 - rho sum sigma_i^2
+//
+//  without going through the pairs. The full pairwise correlation is kept
+//  for the block selected by the start house.
+
+#include "irishData.h"
+
+#include <thread>
+
+// Seed of the random groups, so runs can be repeated
+#define DIVERSITY_SEED          1
+
+// Coincidence of the summed power of one group of houses
+struct groupDiversity {
+    int first;              // first house of a block, -1 for a random group
+    double coincidentPeak;  // highest summed power in W
+    int peakSample;         // sample of the coincident peak
+    double peakSum;         // sum of the individual peaks in W
+    double correlation;     // mean pairwise correlation
+};
+
+class LoadDiversity {
+protected:
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _groupSize;
+    int _firstSample;
+    int _samples;
+    int _houses;
+
+    int _randomGroups;
+    int _threads;
+
+    // Power of every house, one house after the other
+    vector<double> _profiles;
+
+    // Sums of the profiles of all houses before each, one row per house
+    // and one more for the sum of all
+    vector<double> _prefix;
+
+    // Peak and standard deviation of every house, and their sums over all
+    // houses before each
+    vector<double> _peaks;
+    vector<double> _deviations;
+    vector<double> _peakPrefix;
+    vector<double> _deviationPrefix;
+    vector<double> _variancePrefix;
+
+    // Houses of the random groups
+    vector< vector<int> > _members;
+
+    // Blocks first, then the random groups
+    vector<groupDiversity> _groups;
+
+    // Pairwise correlation of the houses of the selected block, row by row
+    vector<double> _correlations;
+
+    // Time of all groups in s
+    double _time;
+
+public:
+    // Uses the given samples from the first, or all following it if none
+    LoadDiversity(IrishData *irishData, int startHouse, int groupSize, int firstSample = 0, int samples = 0);
+
+    void setRandomGroups(int groups);
+    void setThreads(int threads);
+
+    // Builds the prefix sums and computes every group. Returns false if the
+    // data has fewer houses or samples than needed
+    bool run();
+
+    // Writes the groups and the correlation of the selected block as CSV
+    bool save(string path);
+
+    // Diversity factor of a group, blocks first and then the random groups
+    double getDiversity(int group);
+
+    // Highest value, its sample and the sum and sum of squares of a series,
+    // with independent partial sums the compiler can vectorise
+    static void seriesStatistics(const double *series, size_t length, double &peak, int &peakSample, double &sum, double &squares);
+
+    // Pearson correlation of two series of the given mean and standard
+    // deviation
+    static double correlation(const double *first, const double *second, size_t length, double firstMean, double secondMean, double firstDeviation, double secondDeviation);
+
+protected:
+    // Reads the profiles and builds the prefix sums over the houses
+    bool loadProfiles();
+
+    // Draws the houses of the random groups
+    void drawGroups();
+
+    // Computes a range of groups, run on worker threads
+    void computeGroups(int first, int last);
+
+    // Mean correlation of a group from the variance of its summed power and
+    // the deviations of its houses
+    double meanCorrelation(double sum, double squares, double deviationSum, double varianceSum);
+
+    // Fills the pairwise correlation of the selected block
+    void correlateBlock();
+};
+
+#endif /* defined(__DiCOMO__loadDiversity__) */
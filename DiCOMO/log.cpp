@@ -0,0 +1,53 @@
+//
+//  log.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "log.h"
+
+atomic<int> Log::_level(LogInfo);
+
+void Log::setLevel(int level) {
+    if (level < LogError || level > LogTrace) {
+        cout << "ERROR : Unknown log level <" << level << ">" << endl;
+        return;
+    }
+
+    if (level > LOG_COMPILED_LEVEL)
+        cout << "WARNING : Log level <" << levelName(level) << "> is not compiled into this build" << endl;
+
+    _level = level;
+}
+
+int Log::getLevel() {
+    return _level;
+}
+
+bool Log::isEnabled(int level) {
+    return level <= _level.load(memory_order_relaxed);
+}
+
+int Log::parseLevel(string text) {
+    for (int level = LogError; level <= LogTrace; level++)
+        if (text == levelName(level))
+            return level;
+
+    if (text.size() == 1 && text[0] >= '0' && text[0] <= '0' + LogTrace)
+        return text[0] - '0';
+
+    return -1;
+}
+
+const char *Log::levelName(int level) {
+    switch (level) {
+        case LogError:      return "error";
+        case LogWarning:    return "warning";
+        case LogInfo:       return "info";
+        case LogDebug:      return "debug";
+        case LogTrace:      return "trace";
+        default:            return "unknown";
+    }
+}
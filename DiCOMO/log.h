@@ -0,0 +1,56 @@
+//
+//  log.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__log__
+#define __DiCOMO__log__
+
+//  Log levels for the on screen output. Every message guarded by LOG_ENABLED
+//  is only printed if its level is within the level chosen at runtime. Levels
+//  above the compiled level are constant false and so removed entirely by the
+//  compiler. Release builds compile up to LogInfo, which keeps the per pass
+//  and per element output of the solver out of them; debug builds keep all.
+
+#include "backbone.h"
+
+#include <atomic>
+
+enum logLevel {
+    LogError                = 0,
+    LogWarning              = 1,
+    LogInfo                 = 2,
+    LogDebug                = 3,
+    LogTrace                = 4,
+};
+
+// Highest level compiled into the binary, may be passed to the compiler
+#ifndef LOG_COMPILED_LEVEL
+#ifdef DEBUG
+#define LOG_COMPILED_LEVEL      LogTrace
+#else
+#define LOG_COMPILED_LEVEL      LogInfo
+#endif
+#endif
+
+#define LOG_ENABLED(level)      ((level) <= LOG_COMPILED_LEVEL && Log::isEnabled(level))
+
+class Log {
+protected:
+    static atomic<int> _level;
+
+public:
+    // Highest level printed at runtime, LogInfo by default
+    static void setLevel(int level);
+    static int getLevel();
+    static bool isEnabled(int level);
+
+    // Accepts a level's name or number, returns -1 if unknown
+    static int parseLevel(string text);
+    static const char *levelName(int level);
+};
+
+#endif /* defined(__DiCOMO__log__) */
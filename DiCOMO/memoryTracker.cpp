@@ -0,0 +1,208 @@
+//
+//  memoryTracker.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "memoryTracker.h"
+
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define usableSize(pointer)     malloc_size(pointer)
+#else
+#include <malloc.h>
+#define usableSize(pointer)     malloc_usable_size(pointer)
+#endif
+
+atomic<bool> MemoryTracker::_enabled(false);
+memoryCounts MemoryTracker::_stages[NumberOfStages];
+atomic<long> MemoryTracker::_liveBytes(0);
+atomic<long> MemoryTracker::_peakLiveBytes(0);
+map<string, memoryElements> MemoryTracker::_elements;
+mutex MemoryTracker::_elementsMutex;
+
+// Stage and net allocated bytes of the calling thread
+static __thread int currentStage = OtherStage;
+static __thread long currentThreadBytes = 0;
+
+#pragma mark GLOBAL NEW AND DELETE
+
+void *operator new(size_t size) {
+    void *pointer = malloc(size ? size : 1);
+    if (!pointer)
+        throw bad_alloc();
+
+    if (MemoryTracker::isEnabled())
+        MemoryTracker::allocated(usableSize(pointer));
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    if (!pointer)
+        return;
+
+    if (MemoryTracker::isEnabled())
+        MemoryTracker::freed(usableSize(pointer));
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    operator delete(pointer);
+}
+
+#pragma mark MEMORY TRACKER
+
+void MemoryTracker::enable() {
+    _enabled = true;
+}
+
+bool MemoryTracker::isEnabled() {
+    return _enabled.load(memory_order_relaxed);
+}
+
+void MemoryTracker::allocated(size_t bytes) {
+    memoryCounts &counts = _stages[currentStage];
+    counts.allocations.fetch_add(1, memory_order_relaxed);
+    counts.bytesAllocated.fetch_add(bytes, memory_order_relaxed);
+    currentThreadBytes += bytes;
+
+    // Raise the peak if this allocation exceeds it
+    long live = _liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+    long peak = _peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !_peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed));
+}
+
+void MemoryTracker::freed(size_t bytes) {
+    memoryCounts &counts = _stages[currentStage];
+    counts.frees.fetch_add(1, memory_order_relaxed);
+    counts.bytesFreed.fetch_add(bytes, memory_order_relaxed);
+    currentThreadBytes -= bytes;
+    _liveBytes.fetch_sub(bytes, memory_order_relaxed);
+}
+
+int MemoryTracker::getStage() {
+    return currentStage;
+}
+
+void MemoryTracker::setStage(int stage) {
+    currentStage = stage;
+}
+
+long MemoryTracker::threadBytes() {
+    return currentThreadBytes;
+}
+
+void MemoryTracker::addElement(const char *type, long bytesBefore) {
+    if (!isEnabled())
+        return;
+
+    long bytes = threadBytes() - bytesBefore;
+
+    lock_guard<mutex> lock(_elementsMutex);
+    memoryElements &elements = _elements[type];
+    elements.count++;
+    elements.bytes += bytes;
+}
+
+long MemoryTracker::currentRSS() {
+#ifdef __linux__
+    // Total and resident pages
+    long pages = 0, residentPages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        int read = fscanf(statm, "%ld %ld", &pages, &residentPages);
+        fclose(statm);
+        if (read == 2)
+            return residentPages * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return peakRSS();
+}
+
+long MemoryTracker::peakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    // Bytes on OS X
+    return usage.ru_maxrss;
+#else
+    // Kilobytes on Linux
+    return usage.ru_maxrss * 1024L;
+#endif
+}
+
+bool MemoryTracker::save(string path) {
+    ofstream output(path.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << path << ">." << endl;
+        return false;
+    }
+
+    output << "{" << endl;
+    output << "  \"peakRSS\": " << peakRSS() << "," << endl;
+    output << "  \"liveBytes\": " << _liveBytes << "," << endl;
+    output << "  \"peakLiveBytes\": " << _peakLiveBytes << "," << endl;
+
+    output << "  \"stages\": {" << endl;
+    for (int i = 0; i < NumberOfStages; i++) {
+        memoryCounts &counts = _stages[i];
+        output << "    \"" << stageName(i) << "\": {";
+        output << "\"allocations\": " << counts.allocations;
+        output << ", \"frees\": " << counts.frees;
+        output << ", \"bytesAllocated\": " << counts.bytesAllocated;
+        output << ", \"bytesFreed\": " << counts.bytesFreed;
+        output << ", \"bytesRetained\": " << counts.bytesAllocated - counts.bytesFreed << "}";
+        output << (i < NumberOfStages - 1 ? "," : "") << endl;
+    }
+    output << "  }," << endl;
+
+    lock_guard<mutex> lock(_elementsMutex);
+    output << "  \"elements\": {";
+    map<string, memoryElements>::iterator type;
+    for (type = _elements.begin(); type != _elements.end(); type++) {
+        output << (type == _elements.begin() ? "" : ",") << endl;
+        output << "    \"" << type->first << "\": {\"count\": " << type->second.count;
+        output << ", \"bytes\": " << type->second.bytes;
+        output << ", \"bytesPerElement\": " << (type->second.count ? type->second.bytes / type->second.count : 0) << "}";
+    }
+    output << endl << "  }" << endl << "}" << endl;
+    output.close();
+
+    return true;
+}
+
+const char *MemoryTracker::stageName(int stage) {
+    switch (stage) {
+        case OtherStage:        return "other";
+        case LoadStage:         return "load";
+        case AssembleStage:     return "assemble";
+        case SolveStage:        return "solve";
+        case WriteStage:        return "write";
+        default:                return "unknown";
+    }
+}
+
+#pragma mark MEMORY STAGE SCOPE
+
+MemoryStageScope::MemoryStageScope(int stage) {
+    _previous = MemoryTracker::getStage();
+    MemoryTracker::setStage(stage);
+}
+
+MemoryStageScope::~MemoryStageScope() {
+    MemoryTracker::setStage(_previous);
+}
@@ -0,0 +1,104 @@
+//
+//  memoryTracker.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__memoryTracker__
+#define __DiCOMO__memoryTracker__
+
+//  Optional accounting of heap memory. The global operators new and delete
+//  are replaced by versions that, once tracking is enabled, count every
+//  allocation and its usable size. Allocations are attributed to the stage
+//  (load, assemble, solve, write) the allocating thread is in, and assembly
+//  attributes the memory of each new element and its connections to the
+//  element's type. Together with the peak resident set size this shows what
+//  a circuit of a given size costs. While disabled, new and delete only
+//  check a flag.
+
+#include "backbone.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+enum memoryStage {
+    OtherStage              = 0,
+    LoadStage               = 1,
+    AssembleStage           = 2,
+    SolveStage              = 3,
+    WriteStage              = 4,
+    NumberOfStages          = 5,
+};
+
+// Counts of one stage
+struct memoryCounts {
+    atomic<long> allocations;
+    atomic<long> frees;
+    atomic<long> bytesAllocated;
+    atomic<long> bytesFreed;
+};
+
+// Elements of one type and the bytes they took up
+struct memoryElements {
+    long count;
+    long bytes;
+};
+
+class MemoryTracker {
+protected:
+    static atomic<bool> _enabled;
+    static memoryCounts _stages[NumberOfStages];
+
+    // Bytes currently allocated (since enabling) and their maximum
+    static atomic<long> _liveBytes;
+    static atomic<long> _peakLiveBytes;
+
+    static map<string, memoryElements> _elements;
+    static mutex _elementsMutex;
+
+public:
+    // Starts counting. Memory allocated before is not known
+    static void enable();
+    static bool isEnabled();
+
+    // Called by the global operators new and delete
+    static void allocated(size_t bytes);
+    static void freed(size_t bytes);
+
+    // Stage the calling thread's allocations are attributed to
+    static int getStage();
+    static void setStage(int stage);
+
+    // Net bytes allocated by the calling thread since enabling
+    static long threadBytes();
+
+    // Attributes the bytes the calling thread allocated since bytesBefore
+    // (as returned by threadBytes) to one element of the given type
+    static void addElement(const char *type, long bytesBefore);
+
+    // Current and largest resident set size of the process so far in bytes.
+    // The current size falls back to the largest where it is not known
+    static long currentRSS();
+    static long peakRSS();
+
+    // Writes all counts as JSON
+    static bool save(string path);
+
+    static const char *stageName(int stage);
+};
+
+// Attributes the calling thread's allocations to a stage until the end of
+// its scope
+class MemoryStageScope {
+protected:
+    int _previous;
+
+public:
+    MemoryStageScope(int stage);
+    ~MemoryStageScope();
+};
+
+#endif /* defined(__DiCOMO__memoryTracker__) */
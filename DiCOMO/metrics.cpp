@@ -0,0 +1,161 @@
+//
+//  metrics.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "metrics.h"
+
+// Each thread solves its own simulation, so each has its own active metrics
+static __thread Metrics *activeMetrics = NULL;
+
+Metrics::Metrics() {
+    reset();
+}
+
+void Metrics::reset() {
+    for (int i = 0; i < NumberOfTimers; i++) {
+        _seconds[i] = 0.0;
+        _timings[i] = 0;
+    }
+    for (int i = 0; i < NumberOfCounters; i++)
+        _counters[i] = 0;
+
+    _depth = 0;
+}
+
+void Metrics::addTime(int timer, double seconds) {
+    _seconds[timer] += seconds;
+    _timings[timer]++;
+}
+
+double Metrics::getSeconds(int timer) {
+    return _seconds[timer];
+}
+
+long Metrics::getTimings(int timer) {
+    return _timings[timer];
+}
+
+void Metrics::count(int counter, long value) {
+    if (isPeak(counter))
+        _counters[counter] = max(_counters[counter], value);
+    else
+        _counters[counter] += value;
+}
+
+long Metrics::getCounter(int counter) {
+    return _counters[counter];
+}
+
+void Metrics::merge(Metrics *metrics) {
+    for (int i = 0; i < NumberOfTimers; i++) {
+        _seconds[i] += metrics->_seconds[i];
+        _timings[i] += metrics->_timings[i];
+    }
+    for (int i = 0; i < NumberOfCounters; i++)
+        count(i, metrics->_counters[i]);
+}
+
+bool Metrics::save(string path) {
+    ofstream output(path.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << path << ">." << endl;
+        return false;
+    }
+
+    output << setprecision(9);
+    output << "{" << endl << "  \"timers\": {" << endl;
+    for (int i = 0; i < NumberOfTimers; i++) {
+        output << "    \"" << timerName(i) << "\": {\"seconds\": " << _seconds[i];
+        output << ", \"calls\": " << _timings[i] << "}";
+        output << (i < NumberOfTimers - 1 ? "," : "") << endl;
+    }
+    output << "  }," << endl << "  \"counters\": {" << endl;
+    for (int i = 0; i < NumberOfCounters; i++) {
+        output << "    \"" << counterName(i) << "\": " << _counters[i];
+        output << (i < NumberOfCounters - 1 ? "," : "") << endl;
+    }
+    output << "  }" << endl << "}" << endl;
+    output.close();
+
+    return true;
+}
+
+void Metrics::enterImpedance() {
+    _counters[ImpedanceCallCounter]++;
+    _depth++;
+    if (_depth > _counters[ImpedanceDepthCounter])
+        _counters[ImpedanceDepthCounter] = _depth;
+}
+
+void Metrics::leaveImpedance() {
+    _depth--;
+}
+
+Metrics *Metrics::active() {
+    return activeMetrics;
+}
+
+void Metrics::activate(Metrics *metrics) {
+    activeMetrics = metrics;
+}
+
+double Metrics::now() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *Metrics::timerName(int timer) {
+    switch (timer) {
+        case ValidationTimer:       return "validation";
+        case AssemblyTimer:         return "assembly";
+        case SolveTimer:            return "solve";
+        case SaveTimer:             return "save";
+        default:                    return "unknown";
+    }
+}
+
+const char *Metrics::counterName(int counter) {
+    switch (counter) {
+        case SolveCounter:          return "solves";
+        case StateUpdateCounter:    return "stateUpdates";
+        case ImpedanceCallCounter:  return "impedanceCalls";
+        case ImpedanceDepthCounter: return "impedanceDepth";
+        case WorklistPeakCounter:   return "worklistPeak";
+        case IterationCounter:      return "iterations";
+        case ConvergenceCounter:    return "iterationsToConvergence";
+        default:                    return "unknown";
+    }
+}
+
+bool Metrics::isPeak(int counter) {
+    return counter == ImpedanceDepthCounter
+        || counter == WorklistPeakCounter
+        || counter == ConvergenceCounter;
+}
+
+#pragma mark SCOPED PROBES
+
+MetricsTimer::MetricsTimer(Metrics *metrics, int timer) {
+    _metrics = metrics;
+    _timer = timer;
+    _start = metrics ? Metrics::now() : 0.0;
+}
+
+MetricsTimer::~MetricsTimer() {
+    if (_metrics)
+        _metrics->addTime(_timer, Metrics::now() - _start);
+}
+
+ImpedanceProbe::ImpedanceProbe() {
+    _metrics = activeMetrics;
+    if (_metrics)
+        _metrics->enterImpedance();
+}
+
+ImpedanceProbe::~ImpedanceProbe() {
+    if (_metrics)
+        _metrics->leaveImpedance();
+}
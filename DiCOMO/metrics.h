@@ -0,0 +1,114 @@
+//
+//  metrics.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__metrics__
+#define __DiCOMO__metrics__
+
+//  Instrumentation of the simulation stages. A simulation that has been given
+//  a Metrics object times its validation, assembly, solve and save stages with
+//  a monotonic wall clock and counts what the solver does: state updates,
+//  impedance recursions and their depth, the peak size of the interrogation
+//  worklist and the iterations until the voltages stopped changing. Without
+//  a Metrics object every probe is a single pointer check.
+
+#include "backbone.h"
+
+#include <chrono>
+
+// Largest change of any port voltage (in V) after which an iteration is
+// considered converged
+#define METRICS_TOLERANCE       1e-9
+
+enum metricTimer {
+    ValidationTimer         = 0,
+    AssemblyTimer           = 1,
+    SolveTimer              = 2,
+    SaveTimer               = 3,
+    NumberOfTimers          = 4,
+};
+
+enum metricCounter {
+    SolveCounter            = 0,    // solves
+    StateUpdateCounter      = 1,    // calls of getNewState
+    ImpedanceCallCounter    = 2,    // calls of getImpedanceInDirectionOf
+    ImpedanceDepthCounter   = 3,    // deepest impedance recursion (peak)
+    WorklistPeakCounter     = 4,    // largest interrogation worklist (peak)
+    IterationCounter        = 5,    // iterations executed
+    ConvergenceCounter      = 6,    // iterations to convergence (peak)
+    NumberOfCounters        = 7,
+};
+
+class Metrics {
+protected:
+    double _seconds[NumberOfTimers];
+    long _timings[NumberOfTimers];
+    long _counters[NumberOfCounters];
+
+    // Current depth of the impedance recursion
+    long _depth;
+
+public:
+    Metrics();
+
+    void reset();
+
+    void addTime(int timer, double seconds);
+    double getSeconds(int timer);
+    long getTimings(int timer);
+
+    // Adds to a counter, or raises it for peak counters
+    void count(int counter, long value = 1);
+    long getCounter(int counter);
+
+    // Adds the timers and counters of another Metrics object, i.e. of a
+    // simulation run on a worker thread
+    void merge(Metrics *metrics);
+
+    // Writes all timers and counters as JSON
+    bool save(string path);
+
+    // Called on entry and exit of the impedance recursion
+    void enterImpedance();
+    void leaveImpedance();
+
+    // Metrics that the elements evaluated on this thread report to, NULL if
+    // nothing is measured
+    static Metrics *active();
+    static void activate(Metrics *metrics);
+
+    // Monotonic wall-clock time in seconds
+    static double now();
+
+    static const char *timerName(int timer);
+    static const char *counterName(int counter);
+    static bool isPeak(int counter);
+};
+
+// Adds the time until the end of its scope to a timer if metrics are given
+class MetricsTimer {
+protected:
+    Metrics *_metrics;
+    int _timer;
+    double _start;
+
+public:
+    MetricsTimer(Metrics *metrics, int timer);
+    ~MetricsTimer();
+};
+
+// Tracks one level of the impedance recursion on the active metrics
+class ImpedanceProbe {
+protected:
+    Metrics *_metrics;
+
+public:
+    ImpedanceProbe();
+    ~ImpedanceProbe();
+};
+
+#endif /* defined(__DiCOMO__metrics__) */
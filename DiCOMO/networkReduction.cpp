@@ -0,0 +1,559 @@
+//
+//  networkReduction.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "networkReduction.h"
+
+NetworkReduction::NetworkReduction(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor) {
+    _setup = setup;
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _houses = houses;
+    _firstSample = firstSample;
+    _samples = max(1, samples);
+    _powerFactor = powerFactor;
+
+    _first = 0;
+    _last = 0;
+    _connections = 0;
+    _band = 1;
+    _eliminated = 0;
+    _converged = false;
+}
+
+void NetworkReduction::setRange(int first, int last) {
+    _first = first;
+    _last = last;
+}
+
+bool NetworkReduction::run() {
+    if (_first < 0 || _last > _houses || _first >= _last) {
+        cout << "ERROR : Retained range <" << _first << ":" << _last << "> does not lie within the " << _houses << " houses." << endl;
+        return false;
+    }
+
+    Simulation simulation(_setup);
+    simulation.setSolver(ReferenceSolver);
+
+    // The operating point the others are frozen at
+    vector< complex<double> > kept;
+    if (!applySample(&simulation, _firstSample, kept))
+        return false;
+    simulation.solve();
+    if (!simulation.hasConverged()) {
+        cout << "ERROR : Feeder could not be solved at sample " << _firstSample << "." << endl;
+        return false;
+    }
+
+    cout << "Reduction of houses " << _first << " to " << _last-1 << " of " << _houses;
+    cout << " at sample " << _firstSample << " for " << _samples << " sample(s)" << endl;
+
+    double startTime = Metrics::now();
+    if (!reduce(&simulation, _first, _last))
+        return false;
+    double reductionTime = Metrics::now() - startTime;
+
+    if (!solve()) {
+        cout << "ERROR : Reduced network could not be solved at the operating point." << endl;
+        return false;
+    }
+
+    cout << "Nodes :" << setw(22) << _nodes.size() << " retained, " << _eliminated << " eliminated" << endl;
+    cout << "Equivalents :" << setw(16) << _equivalents.size() << " resistor(s), " << getSourceCount() << " source(s)" << endl;
+    cout << "Reduction :" << setw(18) << fixed << setprecision(2) << reductionTime * 1000 << " ms" << endl;
+    cout << "Operating point error :" << setw(6) << scientific << setprecision(2) << compare(&simulation) << " V" << endl;
+
+    for (int i = 0; i < _houses; i++)
+        kept.push_back(simulation.getConnectionPower(i));
+
+    // Only the retained houses follow the samples
+    _fullTimes.clear();
+    _reducedTimes.clear();
+    _errors.clear();
+    for (int sample = _firstSample; sample < _firstSample + _samples; sample++) {
+        if (!applySample(&simulation, sample, kept))
+            return false;
+
+        startTime = Metrics::now();
+        simulation.solve();
+        _fullTimes.push_back(Metrics::now() - startTime);
+
+        for (int i = _first; i < _last; i++)
+            setConnectionPower(i, simulation.getConnectionPower(i));
+        startTime = Metrics::now();
+        bool solved = solve();
+        _reducedTimes.push_back(Metrics::now() - startTime);
+
+        if (!simulation.hasConverged() || !solved) {
+            cout << "ERROR : Sample " << sample << " could not be solved." << endl;
+            return false;
+        }
+        _errors.push_back(compare(&simulation));
+    }
+
+    double fullTime = 0.0, reducedTime = 0.0;
+    for (size_t i = 0; i < _errors.size(); i++) {
+        fullTime += _fullTimes[i] / _errors.size();
+        reducedTime += _reducedTimes[i] / _errors.size();
+    }
+    cout << "Full solve :" << setw(17) << fixed << setprecision(3) << fullTime * 1000 << " ms" << endl;
+    cout << "Reduced solve :" << setw(14) << reducedTime * 1000 << " ms" << endl;
+    cout << "Largest error :" << setw(14) << scientific << setprecision(2) << *max_element(_errors.begin(), _errors.end()) << " V" << endl;
+    cout << fixed;
+
+    return true;
+}
+
+bool NetworkReduction::save(string path) {
+    string file = path + "_reduction.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "Sample,Full (ms),Reduced (ms),Largest error (V)" << endl;
+    for (size_t i = 0; i < _errors.size(); i++)
+        output << _firstSample + i << "," << setprecision(10) << _fullTimes[i] * 1000 << "," << _reducedTimes[i] * 1000 << "," << _errors[i] << endl;
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    file = path + "_equivalents.csv";
+    output.open(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    // Resistors in Ohm, sources as the current in A injected into a node
+    output << "Element,Left node,Right node,Real,Imaginary" << endl;
+    for (size_t i = 0; i < _equivalents.size(); i++) {
+        output << "resistor," << nodeName(_equivalents[i].left) << "," << nodeName(_equivalents[i].right) << ",";
+        output << (double) _equivalents[i].impedance.real() << "," << (double) _equivalents[i].impedance.imag() << endl;
+    }
+    for (size_t i = 0; i < _nodes.size(); i++)
+        if (_injections[i] != 0.0L)
+            output << "source," << nodeName(_nodes[i]) << ",," << (double) _injections[i].real() << "," << (double) _injections[i].imag() << endl;
+    output.close();
+    cout << " File successfully written to:" << endl << file << endl;
+
+    return true;
+}
+
+bool NetworkReduction::reduce(Simulation *simulation, int first, int last) {
+    typedef complex<long double> complexLong;
+
+    if (!simulation->hasConverged()) {
+        cout << "ERROR : Reduction needs a solved operating point." << endl;
+        return false;
+    }
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    long n = simulation->getConnectionCount();
+    int phases = simulation->getPhases();
+    if (n == 0 || impedances.size() != n * 3) {
+        cout << "ERROR : Reduction needs an assembled circuit." << endl;
+        return false;
+    }
+    if (first < 0 || last > n || first >= last) {
+        cout << "ERROR : Retained range <" << first << ":" << last << "> does not lie within the feeder." << endl;
+        return false;
+    }
+
+    // The return line comes first, then per phase each consumer followed by
+    // its feeder segment
+    vector<size_t> consumerOf(n);
+    vector<long> previousOnPhase(n, -1);
+    vector<long> lastOnPhase(phases, -1);
+    size_t index = n;
+    for (int phase = 1; phase <= phases; phase++) {
+        for (long k = 0; k < n; k++) {
+            if (simulation->getConnectionPhase((int) k) != phase)
+                continue;
+            consumerOf[k] = index;
+            previousOnPhase[k] = lastOnPhase[phase-1];
+            lastOnPhase[phase-1] = k;
+            index += 2;
+        }
+    }
+
+    _first = first;
+    _last = last;
+    _connections = (int) n;
+    _fixedVoltages.clear();
+    for (int phase = 1; phase <= phases; phase++) {
+        complex<double> source = simulation->phaseSource(phase);
+        _fixedVoltages.push_back(complexLong(source.real(), source.imag()));
+    }
+    complex<double> sink = simulation->getSink();
+    _fixedVoltages.push_back(complexLong(sink.real(), sink.imag()));
+    long fixed = 2*n;
+    long nodeCount = fixed + phases + 1;
+
+    // Every connection's return segment, feeder segment and consumer at
+    // the operating point. Zero impedances are replaced by a tiny one
+    vector<networkBranch> branches(3*n);
+    vector< complex<double> > operatingVoltages(2*n);
+    for (long k = 0; k < n; k++) {
+        complexLong impedance(impedances[k].real(), impedances[k].imag());
+        networkBranch segment = {2*k, (k > 0) ? 2*k-2 : nodeCount-1, (abs(impedance) != 0) ? impedance : 1e-12L};
+        branches[3*k] = segment;
+
+        impedance = complexLong(impedances[consumerOf[k]+1].real(), impedances[consumerOf[k]+1].imag());
+        networkBranch feeder = {(previousOnPhase[k] >= 0) ? 2*previousOnPhase[k]+1 : fixed + simulation->getConnectionPhase((int) k)-1, 2*k+1, (abs(impedance) != 0) ? impedance : 1e-12L};
+        branches[3*k+1] = feeder;
+
+        networkBranch consumer = {2*k+1, 2*k, impedances[consumerOf[k]].real()};
+        branches[3*k+2] = consumer;
+
+        operatingVoltages[2*k] = rightVoltages[consumerOf[k]];
+        operatingVoltages[2*k+1] = leftVoltages[consumerOf[k]];
+    }
+
+    // Nodes touched by retained and by other branches. Those touched by
+    // both are the ports, the sources and sink are ports of either side
+    vector<bool> retained(nodeCount, false), external(nodeCount, false);
+    for (long b = 0; b < 3*n; b++) {
+        bool inRange = (b/3 >= first && b/3 < last);
+        vector<bool> &touched = inRange ? retained : external;
+        touched[branches[b].left] = true;
+        touched[branches[b].right] = true;
+    }
+
+    vector<long> interiorIndex(nodeCount, -1), portIndex(nodeCount, -1);
+    vector<long> ports;
+    long interiors = 0;
+    for (long node = 0; node < nodeCount; node++) {
+        if (!external[node])
+            continue;
+        if (retained[node] || node >= fixed) {
+            portIndex[node] = (long) ports.size();
+            ports.push_back(node);
+        } else {
+            interiorIndex[node] = interiors++;
+        }
+    }
+
+    // Kron reduction of the other branches onto the ports. The inner nodes
+    // keep the numbering of the feeder, so their matrix is banded
+    size_t kronBand = 1;
+    for (long b = 0; b < 3*n; b++) {
+        long left = interiorIndex[branches[b].left], right = interiorIndex[branches[b].right];
+        if ((b/3 < first || b/3 >= last) && left >= 0 && right >= 0)
+            kronBand = max(kronBand, (size_t) labs(left - right));
+    }
+
+    size_t width = 2*kronBand + 1;
+    size_t portCount = ports.size();
+    vector<complexLong> inner(interiors * width, 0.0L);
+    vector<complexLong> coupling(interiors * portCount, 0.0L);
+    vector<complexLong> reduced(portCount * portCount, 0.0L);
+    vector<complexLong> injections(nodeCount, 0.0L);
+    for (long b = 0; b < 3*n; b++) {
+        if (b/3 >= first && b/3 < last)
+            continue;
+        
+        // The other consumers keep drawing the current of the operating point
+        if (b % 3 == 2) {
+            complexLong current(currents[consumerOf[b/3]].real(), currents[consumerOf[b/3]].imag());
+            injections[branches[b].left] -= current;
+            injections[branches[b].right] += current;
+            continue;
+        }
+        
+        complexLong admittance = 1.0L / branches[b].impedance;
+        long ends[2] = {branches[b].left, branches[b].right};
+        for (int side = 0; side < 2; side++) {
+            long mine = ends[side], other = ends[1-side];
+            if (interiorIndex[mine] >= 0) {
+                inner[interiorIndex[mine]*width + kronBand] += admittance;
+                if (interiorIndex[other] >= 0)
+                    inner[interiorIndex[mine]*width + interiorIndex[other]-interiorIndex[mine]+kronBand] -= admittance;
+                else
+                    coupling[portIndex[other]*interiors + interiorIndex[mine]] -= admittance;
+            } else {
+                reduced[portIndex[mine]*portCount + portIndex[mine]] += admittance;
+                if (portIndex[other] >= 0)
+                    reduced[portIndex[mine]*portCount + portIndex[other]] -= admittance;
+            }
+        }
+    }
+
+    // Y_pp - Y_pi Y_ii^-1 Y_ip, where Y_pi is the transpose of Y_ip, and
+    // I_p - Y_pi Y_ii^-1 I_i for the injected currents
+    vector<complexLong> solved = coupling;
+    solved.resize(interiors * (portCount+1), 0.0L);
+    for (long node = 0; node < nodeCount; node++)
+        if (interiorIndex[node] >= 0)
+            solved[portCount*interiors + interiorIndex[node]] = injections[node];
+    if (interiors > 0)
+        solveBanded(inner, solved, interiors, kronBand, portCount+1);
+    
+    vector<complexLong> portInjections(portCount);
+    for (size_t i = 0; i < portCount; i++) {
+        portInjections[i] = injections[ports[i]];
+        for (long r = 0; r < interiors; r++) {
+            if (coupling[i*interiors + r] == 0.0L)
+                continue;
+            for (size_t j = 0; j < portCount; j++)
+                reduced[i*portCount + j] -= coupling[i*interiors + r] * solved[j*interiors + r];
+            portInjections[i] -= coupling[i*interiors + r] * solved[portCount*interiors + r];
+        }
+    }
+
+    // One equivalent resistor per coupled pair of ports. Between sources
+    // and sink they carry no information
+    _equivalents.clear();
+    for (size_t i = 0; i < portCount; i++) {
+        for (size_t j = i+1; j < portCount; j++) {
+            if (reduced[i*portCount + j] == 0.0L || (ports[i] >= fixed && ports[j] >= fixed))
+                continue;
+            networkBranch equivalent = {ports[i], ports[j], -1.0L / reduced[i*portCount + j]};
+            _equivalents.push_back(equivalent);
+        }
+    }
+    _eliminated = interiors;
+
+    // The retained range keeps its branches and constant powers
+    _segments.clear();
+    _consumers.clear();
+    _powers.clear();
+    for (long k = first; k < last; k++) {
+        _segments.push_back(branches[3*k]);
+        _segments.push_back(branches[3*k+1]);
+        _consumers.push_back(branches[3*k+2]);
+
+        complex<double> power = simulation->getConnectionPower((int) k);
+        _powers.push_back((power.real() < 0.0 ? -1.0L : 1.0L) * abs(power));
+    }
+
+    _nodes.clear();
+    _positions.assign(fixed, -1);
+    _voltages.clear();
+    for (long node = 0; node < fixed; node++) {
+        if (!retained[node])
+            continue;
+        _positions[node] = (long) _nodes.size();
+        _nodes.push_back(node);
+        _voltages.push_back(complexLong(operatingVoltages[node].real(), operatingVoltages[node].imag()));
+    }
+    
+    _injections.assign(_nodes.size(), 0.0L);
+    for (size_t i = 0; i < portCount; i++)
+        if (ports[i] < fixed)
+            _injections[_positions[ports[i]]] = portInjections[i];
+
+    _band = 1;
+    for (int list = 0; list < 2; list++) {
+        vector<networkBranch> &others = (list == 0) ? _segments : _equivalents;
+        for (size_t b = 0; b < others.size(); b++)
+            if (others[b].left < fixed && others[b].right < fixed)
+                _band = max(_band, (size_t) labs(_positions[others[b].left] - _positions[others[b].right]));
+    }
+    _converged = true;
+
+    return true;
+}
+
+void NetworkReduction::setConnectionPower(int connection, complex<double> power) {
+    if (connection < _first || connection >= _last) {
+        cout << "ERROR : Connection <" << connection << "> is not retained" << endl;
+        return;
+    }
+    _powers[connection - _first] = (power.real() < 0.0 ? -1.0L : 1.0L) * abs(power);
+}
+
+bool NetworkReduction::solve() {
+    typedef complex<long double> complexLong;
+
+    size_t nodes = _nodes.size();
+    size_t width = 2*_band + 1;
+    if (nodes == 0)
+        return false;
+
+    // Consumers draw their apparent power as a resistance of |V|^2/|S|,
+    // starting from the previous solution
+    size_t length = _consumers.size();
+    vector<long double> loads(length);
+    for (size_t k = 0; k < length; k++) {
+        complexLong terminal = _voltages[_positions[_consumers[k].left]] - _voltages[_positions[_consumers[k].right]];
+        loads[k] = (_powers[k] != 0) ? norm(terminal) / _powers[k] : INFINITY;
+    }
+    long double nominal = abs(_fixedVoltages.front() - _fixedVoltages.back());
+    _converged = false;
+
+    for (int iteration = 0; iteration < REFERENCE_ITERATIONS; iteration++) {
+        vector<complexLong> matrix(nodes * width, 0.0L);
+        vector<complexLong> currents = _injections;
+
+        for (size_t b = 0; b < _segments.size(); b++)
+            stampBranch(matrix, currents, _segments[b].left, _segments[b].right, 1.0L / _segments[b].impedance);
+        for (size_t b = 0; b < _equivalents.size(); b++)
+            stampBranch(matrix, currents, _equivalents[b].left, _equivalents[b].right, 1.0L / _equivalents[b].impedance);
+        for (size_t k = 0; k < length; k++)
+            if (loads[k] != INFINITY)
+                stampBranch(matrix, currents, _consumers[k].left, _consumers[k].right, 1.0L / loads[k]);
+
+        solveBanded(matrix, currents, nodes, _band, 1);
+
+        // A NaN anywhere must not be hidden by max
+        long double change = 0.0L;
+        for (size_t i = 0; i < nodes; i++) {
+            long double difference = abs(currents[i] - _voltages[i]);
+            if (difference != difference || difference > change)
+                change = difference;
+        }
+        _voltages = currents;
+
+        for (size_t k = 0; k < length; k++) {
+            complexLong terminal = _voltages[_positions[_consumers[k].left]] - _voltages[_positions[_consumers[k].right]];
+            if (_powers[k] != 0)
+                loads[k] = norm(terminal) / _powers[k];
+        }
+
+        if (change < REFERENCE_TOLERANCE) {
+            _converged = true;
+            for (size_t k = 0; k < length; k++)
+                if (_powers[k] != 0 && sqrt(fabs(loads[k] * _powers[k])) < REFERENCE_COLLAPSE * nominal)
+                    _converged = false;
+            break;
+        }
+        if (change != change)
+            break;
+    }
+
+    return _converged;
+}
+
+void NetworkReduction::getConnectionVoltages(vector<double> &voltages) {
+    voltages.assign(_consumers.size(), 0.0);
+    for (size_t k = 0; k < _consumers.size(); k++)
+        voltages[k] = (double) abs(_voltages[_positions[_consumers[k].left]] - _voltages[_positions[_consumers[k].right]]);
+}
+
+long NetworkReduction::getRetainedNodeCount() {
+    return (long) _nodes.size();
+}
+
+long NetworkReduction::getEliminatedNodeCount() {
+    return _eliminated;
+}
+
+int NetworkReduction::getEquivalentCount() {
+    return (int) _equivalents.size();
+}
+
+int NetworkReduction::getSourceCount() {
+    int sources = 0;
+    for (size_t i = 0; i < _injections.size(); i++)
+        if (_injections[i] != 0.0L)
+            sources++;
+    return sources;
+}
+
+bool NetworkReduction::parseRange(string text, int &first, int &last) {
+    size_t colon = text.find(':');
+    if (colon == string::npos || colon == 0 || colon == text.size()-1)
+        return false;
+
+    first = atoi(text.substr(0, colon).c_str());
+    last = atoi(text.substr(colon+1).c_str());
+    return first >= 0 && last > first;
+}
+
+#pragma mark PROTECTED
+
+bool NetworkReduction::applySample(Simulation *simulation, int sample, vector< complex<double> > &kept) {
+    simulation->clearPowers();
+    for (int i = 0; i < _houses; i++)
+        simulation->addPowerToPhase(_irishData->getSampleForHouse(sample, _startHouse + i), _powerFactor, (i % simulation->getPhases()) + 1);
+
+    // Houses outside of the range stay at the operating point
+    for (int i = 0; i < (int) kept.size(); i++)
+        if (i < _first || i >= _last)
+            simulation->setConnectionPower(i, kept[i]);
+
+    // The circuit is only assembled for the first sample
+    if (!simulation->updatePowers()) {
+        if (!simulation->validate())
+            return false;
+        simulation->assemble();
+    }
+    return true;
+}
+
+double NetworkReduction::compare(Simulation *simulation) {
+    vector<double> full, reduced;
+    simulation->getConnectionVoltages(full);
+    getConnectionVoltages(reduced);
+
+    double error = 0.0;
+    for (size_t k = 0; k < reduced.size(); k++) {
+        double difference = fabs(full[_first + k] - reduced[k]);
+        if (difference != difference || difference > error)
+            error = difference;
+    }
+    return error;
+}
+
+string NetworkReduction::nodeName(long node) {
+    stringstream name;
+    if (node < 2*_connections)
+        name << (node % 2 ? "feeder " : "return ") << _startHouse + node/2;
+    else if (node < 2*_connections + (long) _fixedVoltages.size() - 1)
+        name << "source " << node - 2*_connections + 1;
+    else
+        name << "sink";
+    return name.str();
+}
+
+void NetworkReduction::stampBranch(vector< complex<long double> > &matrix, vector< complex<long double> > &currents, long left, long right, complex<long double> admittance) {
+    long fixed = 2*_connections;
+    size_t width = 2*_band + 1;
+    long ends[2] = {left, right};
+
+    for (int side = 0; side < 2; side++) {
+        long mine = ends[side], other = ends[1-side];
+        if (mine >= fixed)
+            continue;
+        long row = _positions[mine];
+        matrix[row*width + _band] += admittance;
+        if (other >= fixed)
+            currents[row] += admittance * _fixedVoltages[other - fixed];
+        else
+            matrix[row*width + _positions[other]-row+_band] -= admittance;
+    }
+}
+
+void NetworkReduction::solveBanded(vector< complex<long double> > &matrix, vector< complex<long double> > &rightHandSides, size_t size, size_t band, size_t count) {
+    typedef complex<long double> complexLong;
+    size_t width = 2*band + 1;
+
+    for (size_t i = 0; i < size; i++) {
+        complexLong pivot = matrix[i*width + band];
+        for (size_t j = i+1; j <= min(size-1, i+band); j++) {
+            complexLong factor = matrix[j*width + i-j+band] / pivot;
+            if (factor == 0.0L)
+                continue;
+            for (size_t c = i; c <= min(size-1, i+band); c++)
+                matrix[j*width + c-j+band] -= factor * matrix[i*width + c-i+band];
+            for (size_t h = 0; h < count; h++)
+                rightHandSides[h*size + j] -= factor * rightHandSides[h*size + i];
+        }
+    }
+
+    for (size_t h = 0; h < count; h++) {
+        complexLong *solution = &rightHandSides[h*size];
+        for (size_t i = size; i-- > 0;) {
+            for (size_t c = i+1; c <= min(size-1, i+band); c++)
+                solution[i] -= matrix[i*width + c-i+band] * solution[c];
+            solution[i] /= matrix[i*width + band];
+        }
+    }
+}
@@ -0,0 +1,154 @@
+//
+//  networkReduction.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__networkReduction__
+#define __DiCOMO__networkReduction__
+
+//  Reduction of a solved feeder to a retained range of connections for
+//  repeated studies of that range. As in a Ward equivalent, the houses
+//  outside of it keep drawing the current of their consumers at the
+//  operating point. The return line and feeder segments outside of the
+//  range then form a linear network with current sources, whose inner nodes
+//  are eliminated by Kron reduction:
+//
+//      Y_eq = Y_pp - Y_pi Y_ii^-1 Y_ip
+//      I_eq = I_p - Y_pi Y_ii^-1 I_i
+//
+//  where p are the ports, the nodes shared with the retained range plus the
+//  sources and the sink, and i are all others. Every entry of Y_eq is an
+//  equivalent resistor between two ports and I_eq a current source into
+//  each. Only the retained consumers keep their constant power, so each
+//  solve of the reduced network is a banded nodal solve over the retained
+//  nodes alone. It reproduces the operating point exactly and deviates from
+//  a full solve as the voltages at the ports move away from it.
+//
+//  Nodes are numbered like the reference solver: node 2k is the return node
+//  of connection k and node 2k+1 its feeder node. The sources follow, then
+//  the sink.
+
+#include "simulation.h"
+#include "irishData.h"
+
+// Branch between two nodes of the full numbering
+struct networkBranch {
+    long left;
+    long right;
+    complex<long double> impedance;
+};
+
+class NetworkReduction {
+protected:
+    // Feeder and return impedances and voltages. Its powers are replaced by
+    // the samples
+    Simulation *_setup;
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _houses;
+    int _firstSample;
+    int _samples;
+    double _powerFactor;
+
+    // Retained connections, from the first up to but not including the last
+    int _first;
+    int _last;
+
+    // Size of the full network and the voltages of its sources and sink
+    int _connections;
+    vector< complex<long double> > _fixedVoltages;
+
+    // Return segments, feeder segments and consumers of the retained range,
+    // and the equivalent resistors of everything else between the ports
+    vector<networkBranch> _segments;
+    vector<networkBranch> _consumers;
+    vector<networkBranch> _equivalents;
+
+    // Equivalent current source into every retained node, only non-zero at
+    // the ports
+    vector< complex<long double> > _injections;
+
+    // Signed apparent power drawn by every retained consumer
+    vector<long double> _powers;
+
+    // Full node number of every retained node and its reverse, -1 for
+    // eliminated nodes. Voltages are those of the retained nodes
+    vector<long> _nodes;
+    vector<long> _positions;
+    vector< complex<long double> > _voltages;
+
+    // Half bandwidth of the reduced nodal matrix and the number of nodes
+    // eliminated
+    size_t _band;
+    long _eliminated;
+
+    bool _converged;
+
+    // Solve times and the largest error of the reduced network for every
+    // sample of the study
+    vector<double> _fullTimes;
+    vector<double> _reducedTimes;
+    vector<double> _errors;
+
+public:
+    NetworkReduction(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor = 1.0);
+
+    void setRange(int first, int last);
+
+    // Reduces the feeder at the first sample and solves the retained range
+    // for every sample while the others keep their powers. Returns false if
+    // the feeder can not be solved or reduced
+    bool run();
+
+    // Writes the error and times of every sample, and the equivalent
+    // resistors, as CSV
+    bool save(string path);
+
+    // Reduces a solved simulation to the given range of connections
+    bool reduce(Simulation *simulation, int first, int last);
+
+    // Changes the power of a retained connection, counted along the full
+    // feeder like in the simulation
+    void setConnectionPower(int connection, complex<double> power);
+
+    // Solves the reduced network. Returns false if it did not converge
+    bool solve();
+
+    // Voltage magnitude across every retained consumer, in connection order
+    void getConnectionVoltages(vector<double> &voltages);
+
+    long getRetainedNodeCount();
+    long getEliminatedNodeCount();
+    int getEquivalentCount();
+    int getSourceCount();
+
+    // Parses a range given as "first:last"
+    static bool parseRange(string text, int &first, int &last);
+
+protected:
+    // Assigns a sample of the Irish data to a simulation, keeping the powers
+    // outside of the retained range if they are given
+    bool applySample(Simulation *simulation, int sample, vector< complex<double> > &kept);
+
+    // Largest difference of the retained voltages to those of a solved
+    // simulation
+    double compare(Simulation *simulation);
+
+    // Name of a node of the full numbering as written to the CSV
+    string nodeName(long node);
+
+    // Adds a branch to a nodal matrix over the given nodes, stored within
+    // the band. Fixed voltages are moved to the right hand side
+    void stampBranch(vector< complex<long double> > &matrix, vector< complex<long double> > &currents, long left, long right, complex<long double> admittance);
+
+    // Gaussian elimination of a banded matrix, element (i, j) stored at
+    // i*(2*band+1) + j-i+band, for several right hand sides stored one after
+    // the other. No pivoting, the nodal matrices are diagonally dominant
+    static void solveBanded(vector< complex<long double> > &matrix, vector< complex<long double> > &rightHandSides, size_t size, size_t band, size_t count);
+};
+
+#endif /* defined(__DiCOMO__networkReduction__) */
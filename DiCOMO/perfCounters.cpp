@@ -0,0 +1,145 @@
+//
+//  perfCounters.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "perfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+// Opens a single counter for the calling thread and the threads it starts
+// later, on any CPU
+static int openCounter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    // User space only, kernel counting is usually not permitted
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    // Worker threads add their counts when they exit. Group reads cannot be
+    // inherited, which is why every counter is read on its own
+    attributes.inherit = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+// Reads value, time enabled and time running of a counter
+static bool readCounter(int descriptor, uint64_t data[3]) {
+    return read(descriptor, data, 3*sizeof(uint64_t)) == (ssize_t) (3*sizeof(uint64_t));
+}
+
+// Cache events are given as cache, operation and result
+static uint64_t cacheEvent(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < NumberOfPerfCounters; i++) {
+        _descriptors[i] = -1;
+        _values[i] = 0.0;
+        for (int j = 0; j < 3; j++)
+            _baselines[i][j] = 0;
+    }
+
+#ifdef __linux__
+    _descriptors[CyclesCounter] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    _descriptors[InstructionsCounter] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    _descriptors[L1DMissCounter] = openCounter(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D));
+    _descriptors[LLCMissCounter] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    _descriptors[BranchMissCounter] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    _descriptors[DTLBMissCounter] = openCounter(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB));
+
+    // Failed counters return -1 already, but keep any other value sane
+    for (int i = 0; i < NumberOfPerfCounters; i++)
+        if (_descriptors[i] < 0)
+            _descriptors[i] = -1;
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < NumberOfPerfCounters; i++)
+        if (_descriptors[i] >= 0)
+            close(_descriptors[i]);
+#endif
+}
+
+bool PerfCounters::isAvailable() {
+    for (int i = 0; i < NumberOfPerfCounters; i++)
+        if (isAvailable(i))
+            return true;
+    return false;
+}
+
+bool PerfCounters::isAvailable(int counter) {
+    return _descriptors[counter] >= 0;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int i = 0; i < NumberOfPerfCounters; i++) {
+        if (_descriptors[i] < 0)
+            continue;
+        ioctl(_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+        if (!readCounter(_descriptors[i], _baselines[i]))
+            for (int j = 0; j < 3; j++)
+                _baselines[i][j] = 0;
+        ioctl(_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+    for (int i = 0; i < NumberOfPerfCounters; i++)
+        if (_descriptors[i] >= 0)
+            ioctl(_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    for (int i = 0; i < NumberOfPerfCounters; i++) {
+        _values[i] = 0.0;
+        if (_descriptors[i] < 0)
+            continue;
+
+        // Value, time enabled and time running since the start
+        uint64_t data[3];
+        if (!readCounter(_descriptors[i], data))
+            continue;
+        for (int j = 0; j < 3; j++)
+            data[j] = (data[j] > _baselines[i][j]) ? data[j] - _baselines[i][j] : 0;
+
+        if (data[2] > 0 && data[2] < data[1])
+            _values[i] = (double) data[0] * data[1] / data[2];
+        else
+            _values[i] = (double) data[0];
+    }
+#endif
+}
+
+double PerfCounters::getValue(int counter) {
+    return _values[counter];
+}
+
+const char *PerfCounters::counterName(int counter) {
+    switch (counter) {
+        case CyclesCounter:         return "cycles";
+        case InstructionsCounter:   return "instructions";
+        case L1DMissCounter:        return "l1dMisses";
+        case LLCMissCounter:        return "llcMisses";
+        case BranchMissCounter:     return "branchMisses";
+        case DTLBMissCounter:       return "dtlbMisses";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  perfCounters.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__perfCounters__
+#define __DiCOMO__perfCounters__
+
+//  Hardware performance counters of the calling thread, read through Linux'
+//  perf_event_open around a measured region. The counters are inherited by
+//  every thread started after they are opened, so the workers of a region
+//  are counted once they have been joined. Each counter is opened on its
+//  own, so a counter that is not supported (or not permitted, as is common in
+//  containers and virtual machines) is simply reported as unavailable while
+//  the others keep working. On other systems no counter is available.
+
+#include "backbone.h"
+
+#include <stdint.h>
+
+enum perfCounter {
+    CyclesCounter           = 0,
+    InstructionsCounter     = 1,
+    L1DMissCounter          = 2,
+    LLCMissCounter          = 3,
+    BranchMissCounter       = 4,
+    DTLBMissCounter         = 5,
+    NumberOfPerfCounters    = 6,
+};
+
+class PerfCounters {
+protected:
+    // File descriptors of the opened counters, -1 if unavailable
+    int _descriptors[NumberOfPerfCounters];
+
+    // Value, time enabled and time running of every counter when the region
+    // started. Counts of exited threads are not cleared by a reset, so the
+    // region is the difference to these
+    uint64_t _baselines[NumberOfPerfCounters][3];
+
+    // Counts of the last measured region
+    double _values[NumberOfPerfCounters];
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // True if at least one counter could be opened
+    bool isAvailable();
+    bool isAvailable(int counter);
+
+    // Enables all counters, then disables them and reads what they counted
+    // in between. Counts are scaled up if the kernel had to multiplex them
+    void start();
+    void stop();
+
+    double getValue(int counter);
+
+    static const char *counterName(int counter);
+};
+
+#endif /* defined(__DiCOMO__perfCounters__) */
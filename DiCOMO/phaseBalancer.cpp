@@ -0,0 +1,228 @@
+//
+//  phaseBalancer.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "phaseBalancer.h"
+
+PhaseBalancer::PhaseBalancer(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor) {
+    _setup = setup;
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _houses = houses;
+    _firstSample = firstSample;
+    _samples = max(1, samples);
+    _powerFactor = powerFactor;
+
+    _objective = ReturnLossObjective;
+    _iterations = 100;
+    _threads = 1;
+
+    _initialValue = 0.0;
+    _bestValue = 0.0;
+}
+
+PhaseBalancer::~PhaseBalancer() {
+    while (!_workers.empty()) {
+        delete _workers.back();
+        _workers.pop_back();
+    }
+}
+
+void PhaseBalancer::setObjective(int objective) {
+    if (objective < 0 || objective >= NumberOfObjectives) {
+        cout << "ERROR : Unknown objective <" << objective << ">" << endl;
+        return;
+    }
+    _objective = objective;
+}
+
+void PhaseBalancer::setIterations(int iterations) {
+    _iterations = max(0, iterations);
+}
+
+void PhaseBalancer::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+bool PhaseBalancer::optimise() {
+    int phases = _setup->getPhases();
+
+    // Round robin, as the Irish data is usually applied
+    _initialPhases.clear();
+    for (int i = 0; i < _houses; i++)
+        _initialPhases.push_back((i % phases) + 1);
+
+    for (int i = (int) _workers.size(); i < _threads; i++)
+        _workers.push_back(new Simulation(_setup));
+
+    _initialValue = evaluate(_workers[0], _initialPhases);
+    if (_initialValue != _initialValue) {
+        cout << "ERROR : Initial phase assignment could not be rated." << endl;
+        return false;
+    }
+    _bestPhases = _initialPhases;
+    _bestValue = _initialValue;
+
+    cout << "Balancing " << _houses << " houses over " << _samples << " sample(s) by ";
+    cout << objectiveName(_objective) << " on " << _threads << " thread(s)" << endl;
+    cout << "Initial :" << setw(20) << fixed << setprecision(4) << _initialValue << endl;
+
+    // Nothing to swap on a single phase
+    if (phases < 2 || _houses < 2)
+        return true;
+
+    srand(BALANCE_SEED);
+
+    vector<int> current = _initialPhases;
+    double currentValue = _initialValue;
+
+    vector< vector<int> > candidates(_threads);
+    vector<double> values(_threads);
+
+    for (int iteration = 0; iteration < _iterations; iteration++) {
+        double temperature = BALANCE_TEMPERATURE * (1.0 - (double) iteration / _iterations);
+
+        // Each candidate swaps two houses on different phases
+        for (int t = 0; t < _threads; t++) {
+            candidates[t] = current;
+            int first = rand() % _houses;
+            int second = rand() % _houses;
+            while (candidates[t][second] == candidates[t][first])
+                second = rand() % _houses;
+            swap(candidates[t][first], candidates[t][second]);
+        }
+
+        vector<thread> evaluations;
+        for (int t = 0; t < _threads; t++)
+            evaluations.push_back(thread(&PhaseBalancer::evaluateCandidate, this, t, &candidates[t], &values[t]));
+        for (int t = 0; t < _threads; t++)
+            evaluations[t].join();
+
+        int chosen = 0;
+        for (int t = 1; t < _threads; t++)
+            if (values[t] < values[chosen])
+                chosen = t;
+
+        // Better candidates are always taken, worse ones with a probability
+        // falling with their relative worsening and the temperature
+        double worsening = (values[chosen] - currentValue) / max(fabs(currentValue), 1e-12);
+        bool accepted = (worsening <= 0.0);
+        if (!accepted && temperature > 0.0)
+            accepted = ((double) rand() / RAND_MAX) < exp(-worsening / temperature);
+
+        if (accepted) {
+            current = candidates[chosen];
+            currentValue = values[chosen];
+        }
+
+        if (currentValue < _bestValue) {
+            _bestPhases = current;
+            _bestValue = currentValue;
+        }
+
+        if (LOG_ENABLED(LogDebug)) {
+            cout << "Iteration " << setw(6) << iteration + 1 << " :";
+            cout << setw(20) << currentValue << "   best" << setw(20) << _bestValue << endl;
+        }
+    }
+
+    cout << "Best :" << setw(23) << _bestValue;
+    cout << "   (" << setprecision(2) << (_initialValue != 0.0 ? (1.0 - _bestValue / _initialValue) * 100.0 : 0.0) << "% better)" << endl;
+
+    return true;
+}
+
+bool PhaseBalancer::save(string path) {
+    string file = path + "_balance.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "House,Initial phase,Balanced phase" << endl;
+    for (size_t i = 0; i < _bestPhases.size(); i++)
+        output << _startHouse + i << "," << _initialPhases[i] << "," << _bestPhases[i] << endl;
+    output << "# " << objectiveName(_objective) << "," << setprecision(10) << _initialValue << "," << _bestValue << endl;
+    output.close();
+
+    cout << " File successfully written to:" << endl << file << endl;
+    return true;
+}
+
+const char *PhaseBalancer::objectiveName(int objective) {
+    switch (objective) {
+        case ReturnLossObjective:   return "loss";
+        case VoltageDropObjective:  return "drop";
+        default:                    return "unknown";
+    }
+}
+
+int PhaseBalancer::parseObjective(string text) {
+    for (int objective = 0; objective < NumberOfObjectives; objective++)
+        if (text == objectiveName(objective))
+            return objective;
+    return -1;
+}
+
+#pragma mark PROTECTED
+
+double PhaseBalancer::evaluate(Simulation *simulation, const vector<int> &phases) {
+    double value = 0.0;
+
+    for (int sample = _firstSample; sample < _firstSample + _samples; sample++) {
+        simulation->clearPowers();
+        for (int i = 0; i < _houses; i++)
+            simulation->addPowerToPhase(_irishData->getSampleForHouse(sample, _startHouse + i), _powerFactor, phases[i]);
+
+        // The circuit only needs to be assembled for a new assignment
+        if (sample == _firstSample || !simulation->updatePowers()) {
+            if (!simulation->validate())
+                return NAN;
+            simulation->assemble();
+        }
+        simulation->solve();
+
+        // Energy adds up over the samples, the drop is the worst of them
+        if (_objective == ReturnLossObjective)
+            value += rate(simulation);
+        else
+            value = max(value, rate(simulation));
+    }
+
+    return value;
+}
+
+void PhaseBalancer::evaluateCandidate(int worker, const vector<int> *phases, double *value) {
+    *value = evaluate(_workers[worker], *phases);
+
+    // Unsolvable candidates are never chosen
+    if (*value != *value)
+        *value = INFINITY;
+}
+
+double PhaseBalancer::rate(Simulation *simulation) {
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    // The return line comes first, then each consumer followed by its
+    // feeder segment
+    size_t returnLine = min((size_t) _houses, currents.size());
+
+    if (_objective == ReturnLossObjective) {
+        double loss = 0.0;
+        for (size_t i = 0; i < returnLine; i++)
+            loss += norm(currents[i]) * impedances[i].real();
+        return loss;
+    }
+
+    double nominal = abs(simulation->getSource() - simulation->getSink());
+    double drop = 0.0;
+    for (size_t i = returnLine; i < currents.size(); i += 2)
+        drop = max(drop, nominal - abs(leftVoltages[i] - rightVoltages[i]));
+    return drop;
+}
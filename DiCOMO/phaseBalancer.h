@@ -0,0 +1,96 @@
+//
+//  phaseBalancer.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__phaseBalancer__
+#define __DiCOMO__phaseBalancer__
+
+//  Searches the phase each house is connected to for a better balanced
+//  feeder. Starting from the usual round robin assignment, simulated annealing
+//  swaps the phases of two houses at a time, which keeps the number of houses
+//  and so the feeder segments of every phase unchanged. An assignment is
+//  rated over a set of Irish data samples by either the energy lost in the
+//  return line or the worst voltage drop at any house.
+//
+//  Every iteration rates one candidate swap per thread in parallel. Each
+//  thread keeps its own simulation for the whole search. A swap rewires the
+//  feeder, so a candidate's circuit is assembled once and then reused for
+//  all samples, which only update the consumer powers.
+
+#include "simulation.h"
+#include "irishData.h"
+
+#include <thread>
+
+// Seed of the candidate moves, so searches can be repeated
+#define BALANCE_SEED            1
+
+// Relative worsening accepted with a probability of 1/e at the start of the
+// search. The temperature falls linearly to zero, ending in a local search
+#define BALANCE_TEMPERATURE     0.02
+
+enum balanceObjective {
+    ReturnLossObjective     = 0,    // energy lost in the return line
+    VoltageDropObjective    = 1,    // worst voltage drop at any house
+    NumberOfObjectives      = 2,
+};
+
+class PhaseBalancer {
+protected:
+    // Feeder and return impedances, voltages and solver. Its powers are
+    // replaced by the samples
+    Simulation *_setup;
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _houses;
+    int _firstSample;
+    int _samples;
+    double _powerFactor;
+
+    int _objective;
+    int _iterations;
+    int _threads;
+
+    // One simulation per thread
+    vector<Simulation *> _workers;
+
+    vector<int> _initialPhases;
+    vector<int> _bestPhases;
+    double _initialValue;
+    double _bestValue;
+
+public:
+    PhaseBalancer(Simulation *setup, IrishData *irishData, int startHouse, int houses, int firstSample, int samples, double powerFactor = 1.0);
+    ~PhaseBalancer();
+
+    void setObjective(int objective);
+    void setIterations(int iterations);
+    void setThreads(int threads);
+
+    // Runs the search. Returns false if the feeder can not be solved
+    bool optimise();
+
+    // Writes the initial and the best phase of every house as CSV
+    bool save(string path);
+
+    static const char *objectiveName(int objective);
+    // Returns -1 if unknown
+    static int parseObjective(string text);
+
+protected:
+    // Rates a phase assignment over all samples, lower is better
+    double evaluate(Simulation *simulation, const vector<int> &phases);
+
+    // Thread entry, rates the candidate of one worker
+    void evaluateCandidate(int worker, const vector<int> *phases, double *value);
+
+    // Return line loss (W) or largest voltage drop (V) of a solved circuit
+    double rate(Simulation *simulation);
+};
+
+#endif /* defined(__DiCOMO__phaseBalancer__) */
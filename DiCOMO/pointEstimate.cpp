@@ -0,0 +1,241 @@
+//
+//  pointEstimate.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "pointEstimate.h"
+
+static const double percentiles[PLF_PERCENTILES] = {0.01, 0.05, 0.50, 0.95, 0.99};
+
+PointEstimate::PointEstimate(Simulation *setup, IrishData *irishData, int startHouse, int houses, int timeOfDay, double powerFactor) {
+    _setup = setup;
+    _irishData = irishData;
+    _startHouse = startHouse;
+    _houses = houses;
+    _timeOfDay = timeOfDay;
+    _powerFactor = powerFactor;
+
+    _threads = 1;
+    _solves = 0;
+    _clippedPoints = 0;
+}
+
+PointEstimate::~PointEstimate() {
+    while (!_workers.empty()) {
+        delete _workers.back();
+        _workers.pop_back();
+    }
+}
+
+void PointEstimate::setThreads(int threads) {
+    _threads = max(1, threads);
+}
+
+bool PointEstimate::run() {
+    _powers.clear();
+    for (int i = 0; i < _houses; i++)
+        _powers.push_back(_irishData->getMomentsForHouse(_startHouse + i, _timeOfDay));
+
+    int threads = min(_threads, _houses);
+    for (int i = (int) _workers.size(); i < threads; i++)
+        _workers.push_back(new Simulation(_setup));
+
+    cout << "Point estimates of " << _houses << " houses at time of day " << _timeOfDay;
+    cout << " over " << _powers[0].days << " days on " << threads << " thread(s)" << endl;
+
+    if (!solveCentre(_workers[0])) {
+        cout << "ERROR : Feeder could not be solved at the mean powers." << endl;
+        return false;
+    }
+    _workers[0]->getConnectionVoltages(_centre);
+    _solves = 1;
+    _clippedPoints = 0;
+    _sums.assign(4 * _houses, 0.0);
+
+    // Consecutive blocks of houses per thread
+    vector<thread> workers;
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        int count = _houses / threads + (t < _houses % threads ? 1 : 0);
+        workers.push_back(thread(&PointEstimate::solvePoints, this, t, first, first + count));
+        first += count;
+    }
+    for (int t = 0; t < threads; t++)
+        workers[t].join();
+
+    // The powers of the houses are independent, so the cumulants of their
+    // voltage changes add up
+    _means.assign(_houses, 0.0);
+    _deviations.assign(_houses, 0.0);
+    _skewnesses.assign(_houses, 0.0);
+    _kurtoses.assign(_houses, 3.0);
+    for (int k = 0; k < _houses; k++) {
+        if (_sums[4*k] != _sums[4*k]) {
+            cout << "ERROR : Feeder could not be solved at every point." << endl;
+            return false;
+        }
+
+        double variance = _sums[4*k+1];
+        _means[k] = _centre[k] + _sums[4*k];
+        if (variance > 0.0) {
+            _deviations[k] = sqrt(variance);
+            _skewnesses[k] = _sums[4*k+2] / pow(variance, 1.5);
+            _kurtoses[k] = 3.0 + _sums[4*k+3] / (variance * variance);
+        }
+    }
+
+    double lowest = *min_element(_means.begin(), _means.end());
+    cout << "Solves :" << setw(21) << _solves << "   (" << _clippedPoints << " point(s) clipped to zero power)" << endl;
+    cout << "Lowest mean :" << setw(16) << fixed << setprecision(2) << lowest << " V" << endl;
+
+    return true;
+}
+
+bool PointEstimate::save(string path) {
+    string file = path + "_plf.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "House,Phase,Mean (V),Deviation (V),Skewness,Kurtosis";
+    for (int p = 0; p < PLF_PERCENTILES; p++)
+        output << ",P" << percentiles[p] * 100.0 << " (V)";
+    output << endl;
+
+    for (int k = 0; k < _houses; k++) {
+        output << _startHouse + k << "," << _workers[0]->getConnectionPhase(k) << ",";
+        output << setprecision(10) << _means[k] << "," << _deviations[k] << "," << _skewnesses[k] << "," << _kurtoses[k];
+        for (int p = 0; p < PLF_PERCENTILES; p++)
+            output << "," << percentile(percentiles[p], _means[k], _deviations[k], _skewnesses[k], _kurtoses[k]);
+        output << endl;
+    }
+    output.close();
+
+    cout << " File successfully written to:" << endl << file << endl;
+    return true;
+}
+
+double PointEstimate::percentile(double probability, double mean, double deviation, double skewness, double kurtosis) {
+    if (deviation <= 0.0 || probability <= 0.0 || probability >= 1.0)
+        return mean;
+
+    // Standard normal quantile by bisection of its distribution function
+    double lower = -10.0, upper = 10.0;
+    for (int i = 0; i < 100; i++) {
+        double middle = 0.5 * (lower + upper);
+        if (0.5 * erfc(-middle / sqrt(2.0)) < probability)
+            lower = middle;
+        else
+            upper = middle;
+    }
+    double z = 0.5 * (lower + upper);
+
+    double excess = kurtosis - 3.0;
+    double w = z + (z*z - 1.0) * skewness / 6.0
+                 + (z*z*z - 3.0*z) * excess / 24.0
+                 - (2.0*z*z*z - 5.0*z) * skewness * skewness / 36.0;
+    return mean + w * deviation;
+}
+
+#pragma mark PROTECTED
+
+void PointEstimate::solvePoints(int worker, int first, int last) {
+    Simulation *simulation = _workers[worker];
+    if (worker > 0 && !solveCentre(simulation)) {
+        lock_guard<mutex> lock(_mutex);
+        _sums[4*first] = NAN;
+        return;
+    }
+
+    vector<double> sums(4 * _houses, 0.0);
+    vector<double> voltages[2];
+    int solves = (worker > 0) ? 1 : 0, clipped = 0;
+
+    for (int j = first; j < last; j++) {
+        powerMoments power = _powers[j];
+
+        // A constant power does not change any voltage
+        if (power.deviation <= 0.0)
+            continue;
+
+        double root = sqrt(max(0.0, power.kurtosis - 0.75 * power.skewness * power.skewness));
+        double locations[2] = {0.5 * power.skewness + root, 0.5 * power.skewness - root};
+        double weights[2] = {1.0 / (locations[0] * (locations[0] - locations[1])),
+                            -1.0 / (locations[1] * (locations[0] - locations[1]))};
+
+        bool solved = true;
+        for (int i = 0; i < 2; i++) {
+            // Consumers only draw power
+            double point = power.mean + locations[i] * power.deviation;
+            if (point < 0.0) {
+                point = 0.0;
+                clipped++;
+            }
+
+            simulation->setConnectionPower(j, powerOf(point));
+            simulation->updatePowers();
+            simulation->solve();
+            simulation->getConnectionVoltages(voltages[i]);
+            solved = solved && simulation->hasConverged();
+            solves++;
+        }
+
+        if (!solved) {
+            sums[4*first] = NAN;
+            continue;
+        }
+
+        // Cumulants of the voltage change this house causes at every house,
+        // from its moments over both points (the mean point changes nothing)
+        for (int k = 0; k < _houses; k++) {
+            double moments[4] = {0.0, 0.0, 0.0, 0.0};
+            for (int i = 0; i < 2; i++) {
+                double difference = voltages[i][k] - _centre[k];
+                double product = weights[i];
+                for (int moment = 0; moment < 4; moment++) {
+                    product *= difference;
+                    moments[moment] += product;
+                }
+            }
+
+            double m1 = moments[0], m2 = moments[1], m3 = moments[2], m4 = moments[3];
+            double variance = m2 - m1*m1;
+            sums[4*k] += m1;
+            sums[4*k+1] += variance;
+            sums[4*k+2] += m3 - 3.0*m1*m2 + 2.0*m1*m1*m1;
+            sums[4*k+3] += m4 - 4.0*m1*m3 + 6.0*m1*m1*m2 - 3.0*m1*m1*m1*m1 - 3.0*variance*variance;
+        }
+
+        simulation->setConnectionPower(j, powerOf(power.mean));
+    }
+
+    lock_guard<mutex> lock(_mutex);
+    for (size_t i = 0; i < sums.size(); i++)
+        _sums[i] += sums[i];
+    _solves += solves;
+    _clippedPoints += clipped;
+}
+
+bool PointEstimate::solveCentre(Simulation *simulation) {
+    simulation->clearPowers();
+    for (int i = 0; i < _houses; i++)
+        simulation->addPowerToPhase(_powers[i].mean, _powerFactor, (i % simulation->getPhases()) + 1);
+
+    if (!simulation->updatePowers()) {
+        if (!simulation->validate())
+            return false;
+        simulation->assemble();
+    }
+    simulation->solve();
+
+    return simulation->hasConverged();
+}
+
+complex<double> PointEstimate::powerOf(double power) {
+    return complex<double>(power * _powerFactor, power * sqrt(1.0 - _powerFactor * _powerFactor));
+}
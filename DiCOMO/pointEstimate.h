@@ -0,0 +1,104 @@
+//
+//  pointEstimate.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__pointEstimate__
+#define __DiCOMO__pointEstimate__
+
+//  Probabilistic load flow by Hong's 2m+1 point estimate method. The power of
+//  every house at one time of day is a random variable whose mean, deviation,
+//  skewness and kurtosis are taken from all days of the Irish data. Each
+//  house is moved to two points around its mean while all others stay at
+//  theirs, plus one solve with every house at its mean:
+//
+//      x = mean + xi * deviation
+//      xi = skewness / 2 +- sqrt(kurtosis - 3 skewness^2 / 4)
+//
+//  The weighted voltages of the two points of a house give the first four
+//  cumulants of the voltage change it causes at every house. The powers are
+//  independent, so these add up to the cumulants of the voltage at every
+//  house, from which the percentiles follow by the Cornish-Fisher expansion.
+//
+//  Houses are split over the threads. Each keeps its own simulation whose
+//  circuit is assembled once at the mean powers.
+
+#include "simulation.h"
+#include "irishData.h"
+
+#include <thread>
+#include <mutex>
+
+// Percentiles of the voltage at every house that are written
+#define PLF_PERCENTILES         5
+
+class PointEstimate {
+protected:
+    // Feeder and return impedances, voltages and solver. Its powers are
+    // replaced by the points
+    Simulation *_setup;
+    IrishData *_irishData;
+
+    int _startHouse;
+    int _houses;
+    int _timeOfDay;
+    double _powerFactor;
+
+    int _threads;
+
+    // One simulation per thread
+    vector<Simulation *> _workers;
+
+    // Distribution of the power of every house
+    vector<powerMoments> _powers;
+
+    // Voltage of every house with all powers at their mean
+    vector<double> _centre;
+
+    // Sums of the 1st to 4th cumulant of the voltage change to the centre,
+    // four per house
+    vector<double> _sums;
+
+    // Moments of the voltage of every house
+    vector<double> _means;
+    vector<double> _deviations;
+    vector<double> _skewnesses;
+    vector<double> _kurtoses;
+
+    // Solves, and points moved to zero power
+    int _solves;
+    int _clippedPoints;
+
+    mutex _mutex;
+
+public:
+    PointEstimate(Simulation *setup, IrishData *irishData, int startHouse, int houses, int timeOfDay, double powerFactor = 1.0);
+    ~PointEstimate();
+
+    void setThreads(int threads);
+
+    // Runs all solves. Returns false if the feeder can not be solved
+    bool run();
+
+    // Writes moments and percentiles of the voltage of every house as CSV
+    bool save(string path);
+
+    // Value below which the given fraction of a distribution with these
+    // moments lies, by the Cornish-Fisher expansion
+    static double percentile(double probability, double mean, double deviation, double skewness, double kurtosis);
+
+protected:
+    // Solves the points of the given range of houses, run on worker threads
+    void solvePoints(int worker, int first, int last);
+
+    // Sets a simulation up with every house at its mean and solves it
+    bool solveCentre(Simulation *simulation);
+
+    // Apparent power of a house as drawn by its consumer
+    complex<double> powerOf(double power);
+};
+
+#endif /* defined(__DiCOMO__pointEstimate__) */
@@ -0,0 +1,102 @@
+//
+//  progressReporter.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "progressReporter.h"
+#include "memoryTracker.h"
+
+#include <chrono>
+
+ProgressReporter::ProgressReporter(string path, double interval) {
+    _path = path;
+    _interval = interval;
+    _task = "";
+    _done = 0;
+    _total = 0;
+    _startTime = now();
+    _running = false;
+
+    if (_path != "stderr") {
+        _file.open(_path.c_str());
+        if (!_file.is_open())
+            cout << "ERROR : Could not generate <" << _path << ">." << endl;
+    }
+}
+
+ProgressReporter::~ProgressReporter() {
+    finish();
+    if (_file.is_open())
+        _file.close();
+}
+
+void ProgressReporter::begin(const char *task, long total) {
+    finish();
+
+    _task = task;
+    _done = 0;
+    _total = total;
+    _startTime = now();
+    _running = true;
+    _reporter = thread(&ProgressReporter::report, this);
+}
+
+void ProgressReporter::advance(long units) {
+    _done.fetch_add(units, memory_order_relaxed);
+}
+
+void ProgressReporter::finish() {
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (!_running)
+            return;
+        _running = false;
+    }
+
+    _wakeUp.notify_all();
+    _reporter.join();
+    writeSnapshot();
+}
+
+#pragma mark PROTECTED
+
+void ProgressReporter::report() {
+    unique_lock<mutex> lock(_mutex);
+    while (_running) {
+        _wakeUp.wait_for(lock, chrono::duration<double>(_interval));
+        if (_running)
+            writeSnapshot();
+    }
+}
+
+void ProgressReporter::writeSnapshot() {
+    double elapsed = now() - _startTime;
+    long done = _done.load(memory_order_relaxed);
+    double rate = (elapsed > 0.0) ? done / elapsed : 0.0;
+
+    stringstream line;
+    line << fixed << setprecision(3);
+    line << "{\"task\": \"" << _task << "\", \"elapsed\": " << elapsed;
+    line << ", \"done\": " << done << ", \"total\": " << _total;
+    line << ", \"perSecond\": " << rate << ", \"eta\": ";
+    if (rate > 0.0)
+        line << max(0.0, (_total - done) / rate);
+    else
+        line << "null";
+    // The kernel updates the peak lazily, so it may lag behind
+    long rss = MemoryTracker::currentRSS();
+    line << ", \"rss\": " << rss;
+    line << ", \"peakRSS\": " << max(rss, MemoryTracker::peakRSS()) << "}";
+
+    if (_file.is_open())
+        _file << line.str() << endl;
+    else if (_path == "stderr")
+        cerr << line.str() << endl;
+}
+
+double ProgressReporter::now() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
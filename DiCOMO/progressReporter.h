@@ -0,0 +1,66 @@
+//
+//  progressReporter.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__progressReporter__
+#define __DiCOMO__progressReporter__
+
+//  Rate limited progress of a long running task. Workers only add to an
+//  atomic counter, while a side thread wakes up at a fixed interval and
+//  appends a snapshot as one line of JSON: units done, units per second,
+//  estimated seconds remaining and memory in use. The solver itself never
+//  waits for any output.
+
+#include "backbone.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Default seconds between two snapshots
+#define PROGRESS_INTERVAL       1.0
+
+class ProgressReporter {
+protected:
+    // Output path, "stderr" for the standard error stream
+    string _path;
+    ofstream _file;
+    double _interval;
+
+    const char *_task;
+    atomic<long> _done;
+    long _total;
+    double _startTime;
+
+    thread _reporter;
+    mutex _mutex;
+    condition_variable _wakeUp;
+    bool _running;
+
+public:
+    ProgressReporter(string path, double interval = PROGRESS_INTERVAL);
+    ~ProgressReporter();
+
+    // Starts reporting a task of the given number of units. A previous task
+    // is finished first
+    void begin(const char *task, long total);
+
+    // Called by the workers whenever units are done. Thread safe
+    void advance(long units = 1);
+
+    // Stops reporting and writes a last snapshot
+    void finish();
+
+protected:
+    void report();
+    void writeSnapshot();
+
+    static double now();
+};
+
+#endif /* defined(__DiCOMO__progressReporter__) */
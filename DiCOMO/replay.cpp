@@ -0,0 +1,111 @@
+//
+//  replay.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "replay.h"
+
+Replay::Replay(string path) {
+    _path = path;
+    _file = NULL;
+    _recording = false;
+    _scenariosRead = 0;
+
+    memset(&_header, 0, sizeof(replayHeader));
+}
+
+Replay::~Replay() {
+    close();
+}
+
+bool Replay::create() {
+    _file = fopen(_path.c_str(), "wb");
+    if (!_file) {
+        cout << "ERROR : Could not generate <" << _path << ">." << endl;
+        return false;
+    }
+
+    memcpy(_header.magic, REPLAY_MAGIC, sizeof(_header.magic));
+    _header.version = REPLAY_VERSION;
+    _header.scenarios = 0;
+    fwrite(&_header, sizeof(replayHeader), 1, _file);
+
+    _recording = true;
+    return true;
+}
+
+bool Replay::open() {
+    _file = fopen(_path.c_str(), "rb");
+    if (!_file) {
+        cout << "ERROR : Could not open <" << _path << ">." << endl;
+        return false;
+    }
+
+    if (fread(&_header, sizeof(replayHeader), 1, _file) != 1
+        || memcmp(_header.magic, REPLAY_MAGIC, sizeof(_header.magic)) != 0) {
+        cout << "ERROR : <" << _path << "> is not a replay file." << endl;
+        close();
+        return false;
+    }
+
+    if (_header.version != REPLAY_VERSION) {
+        cout << "ERROR : Replay version <" << _header.version << "> is not supported." << endl;
+        close();
+        return false;
+    }
+
+    _recording = false;
+    _scenariosRead = 0;
+    return true;
+}
+
+uint64_t Replay::getScenarioCount() {
+    return _header.scenarios;
+}
+
+bool Replay::record(Simulation *simulation, int sample) {
+    lock_guard<mutex> lock(_mutex);
+    if (!_file || !_recording)
+        return false;
+
+    int32_t recordedSample = sample;
+    fwrite(&recordedSample, sizeof(int32_t), 1, _file);
+    if (!simulation->writeScenario(_file))
+        return false;
+
+    _header.scenarios++;
+    return true;
+}
+
+bool Replay::next(Simulation *simulation, int &sample, bool &feederChanged) {
+    if (!_file || _recording || _scenariosRead >= _header.scenarios)
+        return false;
+
+    int32_t recordedSample = 0;
+    if (fread(&recordedSample, sizeof(int32_t), 1, _file) != 1
+        || !simulation->readScenario(_file, feederChanged)) {
+        cout << "ERROR : Scenario <" << _scenariosRead << "> of <" << _path << "> is incomplete." << endl;
+        return false;
+    }
+
+    sample = recordedSample;
+    _scenariosRead++;
+    return true;
+}
+
+void Replay::close() {
+    if (!_file)
+        return;
+
+    // Final number of scenarios
+    if (_recording) {
+        fseek(_file, 0, SEEK_SET);
+        fwrite(&_header, sizeof(replayHeader), 1, _file);
+    }
+
+    fclose(_file);
+    _file = NULL;
+}
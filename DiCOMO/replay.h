@@ -0,0 +1,73 @@
+//
+//  replay.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__replay__
+#define __DiCOMO__replay__
+
+//  A binary file of fully resolved scenarios. Every scenario holds what a
+//  simulation needs to repeat a solve without the Irish data: phases, source
+//  and sink voltages, feeder and return impedances, the powers actually
+//  applied to each phase and the connection order. A header is followed by
+//  the scenarios one after another, each preceded by its sample:
+//
+//      header | sample 0, scenario 0 | sample 1, scenario 1 | ...
+//
+//  Recording is thread safe, so worker threads can append their samples.
+
+#include "simulation.h"
+
+#include <mutex>
+
+#define REPLAY_MAGIC        "DICOMOS"
+#define REPLAY_VERSION      1
+
+// Fixed part at the very beginning of a replay file
+struct replayHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t scenarios;
+};
+
+class Replay {
+protected:
+    string _path;
+    FILE *_file;
+    bool _recording;
+
+    replayHeader _header;
+
+    // Scenarios read so far
+    uint64_t _scenariosRead;
+
+    mutex _mutex;
+
+public:
+    Replay(string path);
+    ~Replay();
+
+    // Creates the file for recording or opens it for replaying
+    bool create();
+    bool open();
+
+    // Number of scenarios in the file, or recorded so far
+    uint64_t getScenarioCount();
+
+    // Appends the scenario the simulation is currently set up with
+    bool record(Simulation *simulation, int sample);
+
+    // Sets the simulation up with the next scenario. Returns false once all
+    // scenarios are read. feederChanged is true unless only the powers differ
+    // from the previous scenario, in which case the circuit can be reused
+    bool next(Simulation *simulation, int &sample, bool &feederChanged);
+
+    // Writes the final header when recording
+    void close();
+};
+
+#endif /* defined(__DiCOMO__replay__) */
@@ -77,7 +77,21 @@ complex<double> Resistor::getImpedance() {
     return _resistorState.value;
 }
 
+complex<double> Resistor::getLeftVoltage() {
+    return _leftPortVoltage.value;
+}
+
+complex<double> Resistor::getRightVoltage() {
+    return _rightPortVoltage.value;
+}
+
+complex<double> Resistor::getCurrent() {
+    return _leftPortCurrent.value;
+}
+
 complex<double> Resistor::getImpedanceInDirectionOf(string mine) {
+    ImpedanceProbe probe;
+    
     // Before continuing, check if this element is an open circuit
     if (getImpedance().real() == INFINITY)
         return INFINITY;
@@ -10,6 +10,7 @@
 #define __DiCOMO__resistor__
 
 #include "element.h"
+#include "metrics.h"
 
 using namespace std;
 
@@ -40,6 +41,12 @@ public:
     void setImpedance(complex<double> impedance);
     complex<double> getImpedance();
     
+    // Direct access to the port states without looking them up by name.
+    // The current is the one entering the left port
+    complex<double> getLeftVoltage();
+    complex<double> getRightVoltage();
+    complex<double> getCurrent();
+    
 protected:
     // Function that returns the impedance in the direction of a port
     // i.e. the impedance of the adjacent circuit
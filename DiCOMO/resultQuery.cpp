@@ -0,0 +1,326 @@
+//
+//  resultQuery.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "resultQuery.h"
+
+ResultQuery::ResultQuery(string path) {
+    _path = path;
+    _reader = new ResultReader(path);
+}
+
+ResultQuery::~ResultQuery() {
+    delete _reader;
+}
+
+bool ResultQuery::open() {
+    if (!_reader->open())
+        return false;
+
+    // Element index
+    _elements.clear();
+    for (uint64_t i = 0; i < _reader->getElementCount(); i++)
+        _elements[_reader->getElementName(i)] = i;
+
+    // Zone maps are only built if there is no valid index file yet
+    if (!loadIndex() && !buildIndex())
+        return false;
+
+    return true;
+}
+
+int ResultQuery::quantityFromName(string name) {
+    if (name == "voltage")
+        return QueryVoltage;
+    if (name == "current")
+        return QueryCurrent;
+    if (name == "power")
+        return QueryPower;
+    return -1;
+}
+
+bool ResultQuery::point(string element, int quantity, uint64_t sample, queryResult &result) {
+    vector<queryResult> results;
+    if (!range(element, quantity, sample, sample, results) || results.empty())
+        return false;
+
+    result = results[0];
+    return true;
+}
+
+bool ResultQuery::range(string element, int quantity, uint64_t first, uint64_t last, vector<queryResult> &results) {
+    results.clear();
+
+    unordered_map<string, uint64_t>::iterator entry = _elements.find(element);
+    if (entry == _elements.end()) {
+        cout << "ERROR : Element <" << element << "> is not in the results." << endl;
+        return false;
+    }
+
+    uint64_t stored, lastStored;
+    if (!toStored(first, last, stored, lastStored))
+        return false;
+
+    // Only the chunks that cover the range are read
+    uint64_t chunkSamples = _reader->getChunkSamples();
+    for (; stored <= lastStored; stored++) {
+        queryResult result;
+        result.element = element;
+        result.sample = stored + _reader->getFirstSample();
+        result.value = derive(stored / chunkSamples, entry->second, quantity, stored % chunkSamples);
+        results.push_back(result);
+    }
+
+    return true;
+}
+
+bool ResultQuery::threshold(string prefix, int quantity, bool below, double limit, uint64_t first, uint64_t last, vector<queryResult> &results) {
+    results.clear();
+
+    uint64_t firstStored, lastStored;
+    if (!toStored(first, last, firstStored, lastStored))
+        return false;
+
+    uint64_t elements = _reader->getElementCount();
+    uint64_t chunkSamples = _reader->getChunkSamples();
+
+    for (uint64_t element = 0; element < elements; element++) {
+        string name = _reader->getElementName(element);
+        if (name.compare(0, prefix.size(), prefix) != 0)
+            continue;
+
+        for (uint64_t chunk = firstStored / chunkSamples; chunk <= lastStored / chunkSamples; chunk++) {
+            // Skip chunks that can not contain a match
+            uint64_t zone = (chunk * elements + element) * NumberOfQueries + quantity;
+            if (below ? _minimums[zone] >= limit : _maximums[zone] <= limit)
+                continue;
+
+            uint64_t from = max(firstStored, chunk * chunkSamples);
+            uint64_t to = min(lastStored, (chunk + 1) * chunkSamples - 1);
+            for (uint64_t stored = from; stored <= to; stored++) {
+                double value = derive(chunk, element, quantity, stored % chunkSamples);
+                if (below ? value < limit : value > limit) {
+                    queryResult result;
+                    result.element = name;
+                    result.sample = stored + _reader->getFirstSample();
+                    result.value = value;
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ResultQuery::execute(string query) {
+    // Split the query into words
+    vector<string> words;
+    stringstream queryStream(query);
+    string word;
+    while (queryStream >> word)
+        words.push_back(word);
+
+    int quantity = words.empty() ? -1 : quantityFromName(words[0]);
+    if (quantity < 0) {
+        cout << "ERROR : Query must start with 'voltage', 'current' or 'power'." << endl;
+        return false;
+    }
+
+    vector<queryResult> results;
+    uint64_t first, last;
+
+    if (words.size() == 3 && parseSamples(words[2], first, last)) {
+        // Point or range of a single element
+        if (!range(words[1], quantity, first, last, results))
+            return false;
+
+    } else if (words.size() == 5 && (words[2] == "<" || words[2] == ">")
+               && parseSamples(words[4], first, last)) {
+        // Threshold over all elements of a type
+        if (!threshold(words[1], quantity, words[2] == "<", atof(words[3].c_str()), first, last, results))
+            return false;
+
+    } else {
+        cout << "ERROR : Can not interpret query <" << query << ">" << endl;
+        return false;
+    }
+
+    // Print in the same manner as the CSV output
+    string text;
+    for (size_t i = 0; i < results.size(); i++) {
+        text.append(results[i].element);
+        text.push_back(',');
+        CSVWriter::appendValue(text, (double) results[i].sample);
+        text.push_back(',');
+        CSVWriter::appendValue(text, results[i].value);
+        text.push_back('\n');
+    }
+    cout << "Name,Sample," << words[0] << endl << text;
+
+    return true;
+}
+
+#pragma mark PROTECTED
+
+bool ResultQuery::loadIndex() {
+    string path = _path + ".dci";
+    ifstream input(path.c_str(), ios::binary);
+    if (!input.is_open())
+        return false;
+
+    uint64_t chunkSamples = _reader->getChunkSamples();
+    uint64_t chunks = (_reader->getSampleCount() + chunkSamples - 1) / chunkSamples;
+
+    // The index is only valid for the store it was built from. A store
+    // written again with the same sizes is told apart by its first sample,
+    // size and time of modification
+    queryIndexHeader store;
+    if (!describeStore(store))
+        return false;
+
+    queryIndexHeader header;
+    input.read((char *)&header, sizeof(queryIndexHeader));
+    if (!input.good()
+        || memcmp(header.magic, QUERY_INDEX_MAGIC, sizeof(QUERY_INDEX_MAGIC)) != 0
+        || header.version != QUERY_INDEX_VERSION
+        || header.quantities != NumberOfQueries
+        || header.elements != _reader->getElementCount()
+        || header.chunks != chunks
+        || header.samples != _reader->getSampleCount()
+        || header.firstSample != store.firstSample
+        || header.storeSize != store.storeSize
+        || header.storeModified != store.storeModified)
+        return false;
+
+    size_t zones = chunks * header.elements * NumberOfQueries;
+    _minimums.resize(zones);
+    _maximums.resize(zones);
+    input.read((char *)&_minimums[0], zones * sizeof(double));
+    input.read((char *)&_maximums[0], zones * sizeof(double));
+
+    return input.good();
+}
+
+bool ResultQuery::buildIndex() {
+    uint64_t elements = _reader->getElementCount();
+    uint64_t samples = _reader->getSampleCount();
+    uint64_t chunkSamples = _reader->getChunkSamples();
+    uint64_t chunks = (samples + chunkSamples - 1) / chunkSamples;
+
+    size_t zones = chunks * elements * NumberOfQueries;
+    _minimums.assign(zones, INFINITY);
+    _maximums.assign(zones, -INFINITY);
+
+    // One pass over the entire store, chunk by chunk
+    for (uint64_t chunk = 0; chunk < chunks; chunk++) {
+        uint64_t length = min(chunkSamples, samples - chunk * chunkSamples);
+
+        for (uint64_t element = 0; element < elements; element++) {
+            for (int quantity = 0; quantity < NumberOfQueries; quantity++) {
+                uint64_t zone = (chunk * elements + element) * NumberOfQueries + quantity;
+                for (uint64_t offset = 0; offset < length; offset++) {
+                    double value = derive(chunk, element, quantity, offset);
+                    _minimums[zone] = min(_minimums[zone], value);
+                    _maximums[zone] = max(_maximums[zone], value);
+                }
+            }
+        }
+    }
+
+    // Keep the index for the next query
+    string path = _path + ".dci";
+    queryIndexHeader header;
+    memset(&header, 0, sizeof(queryIndexHeader));
+    ofstream output(path.c_str(), ios::binary);
+    if (output.is_open() && describeStore(header)) {
+        memcpy(header.magic, QUERY_INDEX_MAGIC, sizeof(QUERY_INDEX_MAGIC));
+        header.version = QUERY_INDEX_VERSION;
+        header.quantities = NumberOfQueries;
+        header.elements = elements;
+        header.chunks = chunks;
+        header.samples = samples;
+
+        output.write((const char *)&header, sizeof(queryIndexHeader));
+        output.write((const char *)&_minimums[0], zones * sizeof(double));
+        output.write((const char *)&_maximums[0], zones * sizeof(double));
+        output.close();
+    }
+
+    return true;
+}
+
+bool ResultQuery::describeStore(queryIndexHeader &header) {
+    struct stat fileStatus;
+    if (stat(_path.c_str(), &fileStatus) != 0)
+        return false;
+
+    header.firstSample = _reader->getFirstSample();
+    header.storeSize = (uint64_t) fileStatus.st_size;
+    header.storeModified = (uint64_t) fileStatus.st_mtime;
+    return true;
+}
+
+double ResultQuery::derive(uint64_t chunk, uint64_t element, int quantity, uint64_t offset) {
+    switch (quantity) {
+        case QueryVoltage: {
+            complex<double> voltageL(_reader->getChunkColumn(chunk, element, VoltageLeftReal)[offset],
+                                     _reader->getChunkColumn(chunk, element, VoltageLeftImag)[offset]);
+            complex<double> voltageR(_reader->getChunkColumn(chunk, element, VoltageRightReal)[offset],
+                                     _reader->getChunkColumn(chunk, element, VoltageRightImag)[offset]);
+            return abs(voltageL - voltageR);
+        }
+        case QueryCurrent:
+            return abs(complex<double>(_reader->getChunkColumn(chunk, element, CurrentReal)[offset],
+                                       _reader->getChunkColumn(chunk, element, CurrentImag)[offset]));
+        case QueryPower:
+            return _reader->getChunkColumn(chunk, element, PowerReal)[offset];
+        default:
+            return NAN;
+    }
+}
+
+bool ResultQuery::toStored(uint64_t first, uint64_t last, uint64_t &firstStored, uint64_t &lastStored) {
+    // Samples are stored consecutively from the first one onwards
+    uint64_t firstSample = _reader->getFirstSample();
+    uint64_t lastSample = firstSample + _reader->getSampleCount() - 1;
+
+    if (_reader->getSampleCount() == 0 || last < firstSample || first > lastSample) {
+        cout << "ERROR : Samples <" << first << ":" << last << "> are not in the results." << endl;
+        return false;
+    }
+
+    firstStored = max(first, firstSample) - firstSample;
+    lastStored = min(last, lastSample) - firstSample;
+    return true;
+}
+
+bool ResultQuery::parseSamples(string text, uint64_t &first, uint64_t &last) {
+    if (text.empty())
+        return false;
+
+    // Weeks are counted from one, "w3:5" covers weeks three to five
+    bool weeks = (text[0] == 'w');
+    if (weeks)
+        text.erase(0, 1);
+
+    if (text.empty() || text.find_first_not_of("0123456789:") != string::npos)
+        return false;
+
+    size_t colon = text.find(':');
+    first = strtoull(text.substr(0, colon).c_str(), NULL, 10);
+    last = (colon == string::npos) ? first : strtoull(text.substr(colon+1).c_str(), NULL, 10);
+
+    if (weeks) {
+        if (first == 0 || last == 0)
+            return false;
+        first = (first - 1) * SAMPLES_PER_WEEK;
+        last = last * SAMPLES_PER_WEEK - 1;
+    }
+
+    return first <= last;
+}
@@ -0,0 +1,117 @@
+//
+//  resultQuery.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__resultQuery__
+#define __DiCOMO__resultQuery__
+
+//  Point, range and threshold queries over a binary result store. Elements
+//  are found by the names given by Element::elementName through a hash index
+//  and samples are addressed by their Irish data sample number. For threshold
+//  queries the minimum and maximum of every element's quantity is kept for
+//  each chunk of the store, so chunks that can not contain a match are never
+//  read. These zone maps are built once and kept next to the store in
+//  "<store>.dci".
+
+#include "resultStore.h"
+#include "csvWriter.h"
+
+#include <unordered_map>
+
+#define QUERY_INDEX_MAGIC       "DICOMOI"
+#define QUERY_INDEX_VERSION     2
+
+// Samples per week of the Irish data (30 minute samples)
+#define SAMPLES_PER_WEEK        336
+
+// Quantities that can be queried, derived from the stored columns
+enum queryQuantity {
+    QueryVoltage        = 0,    // |V_l - V_r|
+    QueryCurrent        = 1,    // |I|
+    QueryPower          = 2,    // Re(S)
+    NumberOfQueries     = 3,
+};
+
+// A single match of a query
+struct queryResult {
+    string element;
+    uint64_t sample;
+    double value;
+};
+
+// Fixed part at the beginning of an index file
+struct queryIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t quantities;
+    uint64_t elements;
+    uint64_t chunks;
+    uint64_t samples;
+    uint64_t firstSample;
+    uint64_t storeSize;         // in bytes
+    uint64_t storeModified;     // in s since the epoch
+};
+
+class ResultQuery {
+protected:
+    string _path;
+    ResultReader *_reader;
+
+    // Element index by name
+    unordered_map<string, uint64_t> _elements;
+
+    // Zone maps, minimum and maximum per chunk, element and quantity
+    vector<double> _minimums;
+    vector<double> _maximums;
+
+public:
+    ResultQuery(string path);
+    ~ResultQuery();
+
+    // Opens the store, builds the element index and loads or builds the
+    // zone maps
+    bool open();
+
+    // Translates "voltage", "current" or "power" into a quantity, -1 if unknown
+    static int quantityFromName(string name);
+
+    // Value of one element at one sample
+    bool point(string element, int quantity, uint64_t sample, queryResult &result);
+
+    // Values of one element over the samples first to last (inclusive)
+    bool range(string element, int quantity, uint64_t first, uint64_t last, vector<queryResult> &results);
+
+    // All elements whose name starts with prefix and whose quantity lies
+    // below (or above) the limit between the samples first and last
+    bool threshold(string prefix, int quantity, bool below, double limit, uint64_t first, uint64_t last, vector<queryResult> &results);
+
+    // Parses and executes a textual query and prints the results, e.g.
+    //  "voltage consumer_217 w3:5"         range over weeks 3 to 5
+    //  "voltage consumer < 216 4100"       all houses below 216V at 4100
+    //  "current resistor_0 1008"           point
+    bool execute(string query);
+
+protected:
+    // Loads the zone maps from file or builds them from the store
+    bool loadIndex();
+    bool buildIndex();
+
+    // Fills the fields of an index header that identify the store
+    bool describeStore(queryIndexHeader &header);
+
+    // Computes a quantity for a sample within a chunk from the columns
+    double derive(uint64_t chunk, uint64_t element, int quantity, uint64_t offset);
+
+    // Converts an inclusive range of Irish data sample numbers into the
+    // stored samples it overlaps. Returns false if there is no overlap
+    bool toStored(uint64_t first, uint64_t last, uint64_t &firstStored, uint64_t &lastStored);
+
+    // Parses "n", "a:b" or "wA:B" into an inclusive range of samples
+    static bool parseSamples(string text, uint64_t &first, uint64_t &last);
+};
+
+#endif /* defined(__DiCOMO__resultQuery__) */
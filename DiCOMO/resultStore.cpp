@@ -0,0 +1,341 @@
+//
+//  resultStore.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "resultStore.h"
+
+#pragma mark RESULT STORE
+
+ResultStore::ResultStore(string path, uint64_t chunkSamples) {
+    _path = path;
+    _file = NULL;
+    _samplesInChunk = 0;
+
+    memset(&_header, 0, sizeof(resultHeader));
+    _header.chunkSamples = (chunkSamples > 0) ? chunkSamples : 1;
+}
+
+ResultStore::~ResultStore() {
+    close();
+}
+
+bool ResultStore::open(vector<string> names, vector<int> phases, uint64_t firstSample) {
+    if (_file) {
+        cout << "ERROR : Result store <" << _path << "> is already open." << endl;
+        return false;
+    }
+
+    if (names.size() != phases.size() || names.empty()) {
+        cout << "ERROR : Element names and phases do not match." << endl;
+        return false;
+    }
+
+    _file = fopen(_path.c_str(), "wb");
+    if (!_file) {
+        cout << "ERROR : Could not generate <" << _path << ">." << endl;
+        return false;
+    }
+
+    // The zone maps of a previous store no longer apply
+    remove((_path + ".dci").c_str());
+
+    // Limit the chunk so that the buffered values stay within bounds
+    uint64_t bytesPerSample = names.size() * NumberOfQuantities * sizeof(double);
+    if (_header.chunkSamples * bytesPerSample > RESULT_CHUNK_BYTES)
+        _header.chunkSamples = max((uint64_t)1, (uint64_t)(RESULT_CHUNK_BYTES / bytesPerSample));
+
+    memcpy(_header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+    _header.version = RESULT_VERSION;
+    _header.quantities = NumberOfQuantities;
+    _header.elements = names.size();
+    _header.samples = 0;
+    _header.firstSample = firstSample;
+
+    // Serialise the element table and the quantity names after the header
+    string table;
+    for (size_t i = 0; i < names.size(); i++) {
+        int32_t phase = phases[i];
+        uint32_t length = (uint32_t) names[i].size();
+        table.append((const char *)&phase, sizeof(phase));
+        table.append((const char *)&length, sizeof(length));
+        table.append(names[i]);
+    }
+    string quantities = RESULT_QUANTITIES;
+    uint32_t length = (uint32_t) quantities.size();
+    table.append((const char *)&length, sizeof(length));
+    table.append(quantities);
+
+    // Align the first chunk to a page
+    uint64_t tableEnd = sizeof(resultHeader) + table.size();
+    _header.dataOffset = (tableEnd + RESULT_ALIGNMENT - 1) / RESULT_ALIGNMENT * RESULT_ALIGNMENT;
+    table.append(_header.dataOffset - tableEnd, '\0');
+
+    fwrite(&_header, sizeof(resultHeader), 1, _file);
+    fwrite(table.data(), 1, table.size(), _file);
+
+    // Unused entries of the last chunk remain NaN
+    _chunk.assign(_header.chunkSamples * _header.elements * NumberOfQuantities, NAN);
+    _samplesInChunk = 0;
+
+    return true;
+}
+
+bool ResultStore::isOpen() {
+    return _file != NULL;
+}
+
+void ResultStore::appendSample(const vector<double> &values) {
+    if (!_file) {
+        cout << "ERROR : Result store <" << _path << "> has not been opened." << endl;
+        return;
+    }
+
+    if (values.size() != _header.elements * NumberOfQuantities) {
+        cout << "ERROR : Sample does not match the elements in <" << _path << ">." << endl;
+        return;
+    }
+
+    // Scatter the values into the columns of the current chunk
+    uint64_t chunkSamples = _header.chunkSamples;
+    double *chunk = &_chunk[0];
+    for (size_t i = 0; i < values.size(); i++)
+        chunk[i * chunkSamples + _samplesInChunk] = values[i];
+
+    _samplesInChunk++;
+    if (_samplesInChunk == chunkSamples)
+        flushChunk();
+}
+
+void ResultStore::close() {
+    if (!_file)
+        return;
+
+    if (_samplesInChunk > 0)
+        flushChunk();
+
+    fclose(_file);
+    _file = NULL;
+}
+
+#pragma mark PROTECTED
+
+void ResultStore::flushChunk() {
+    TraceSpan span("flush result chunk");
+    
+    // Write the entire chunk in one go
+    fwrite(&_chunk[0], sizeof(double), _chunk.size(), _file);
+
+    // Keep the header up to date so that the file is readable at any time
+    _header.samples += _samplesInChunk;
+    fseek(_file, 0, SEEK_SET);
+    fwrite(&_header, sizeof(resultHeader), 1, _file);
+    fseek(_file, 0, SEEK_END);
+
+    _chunk.assign(_chunk.size(), NAN);
+    _samplesInChunk = 0;
+}
+
+#pragma mark RESULT READER
+
+ResultReader::ResultReader(string path) {
+    _path = path;
+    _fileDescriptor = -1;
+    _data = NULL;
+    _size = 0;
+    memset(&_header, 0, sizeof(resultHeader));
+}
+
+ResultReader::~ResultReader() {
+    if (_data)
+        munmap((void *)_data, _size);
+    if (_fileDescriptor >= 0)
+        ::close(_fileDescriptor);
+}
+
+bool ResultReader::open() {
+    _fileDescriptor = ::open(_path.c_str(), O_RDONLY);
+    if (_fileDescriptor < 0) {
+        cout << "ERROR : Can not open file at:" << endl;
+        cout << _path << endl;
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(_fileDescriptor, &fileStatus) != 0) {
+        cout << "ERROR : Can not read the size of <" << _path << ">." << endl;
+        return false;
+    }
+    _size = fileStatus.st_size;
+
+    if (_size < sizeof(resultHeader)) {
+        cout << "ERROR : <" << _path << "> is not a result file." << endl;
+        return false;
+    }
+
+    void *data = mmap(NULL, _size, PROT_READ, MAP_SHARED, _fileDescriptor, 0);
+    if (data == MAP_FAILED) {
+        cout << "ERROR : Could not map <" << _path << ">." << endl;
+        return false;
+    }
+    _data = (const char *)data;
+
+    // Check the header
+    memcpy(&_header, _data, sizeof(resultHeader));
+    if (memcmp(_header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC)) != 0
+        || _header.version != RESULT_VERSION
+        || _header.chunkSamples == 0
+        || _header.dataOffset < sizeof(resultHeader)
+        || _header.dataOffset > _size) {
+        cout << "ERROR : <" << _path << "> is not a result file." << endl;
+        return false;
+    }
+
+    // Read the element table. Every length read from the file is checked
+    // against the end of the table before it is followed
+    const char *entry = _data + sizeof(resultHeader);
+    const char *tableEnd = _data + _header.dataOffset;
+    for (uint64_t i = 0; i < _header.elements; i++) {
+        int32_t phase;
+        uint32_t length;
+        if ((size_t)(tableEnd - entry) < sizeof(phase) + sizeof(length)) {
+            cout << "ERROR : <" << _path << "> has a corrupt element table." << endl;
+            return false;
+        }
+        memcpy(&phase, entry, sizeof(phase));
+        entry += sizeof(phase);
+        memcpy(&length, entry, sizeof(length));
+        entry += sizeof(length);
+        if (length > (size_t)(tableEnd - entry)) {
+            cout << "ERROR : <" << _path << "> has a corrupt element table." << endl;
+            return false;
+        }
+
+        _phases.push_back(phase);
+        _names.push_back(string(entry, length));
+        entry += length;
+    }
+
+    // Read the quantity names
+    uint32_t length;
+    if ((size_t)(tableEnd - entry) < sizeof(length)) {
+        cout << "ERROR : <" << _path << "> has a corrupt element table." << endl;
+        return false;
+    }
+    memcpy(&length, entry, sizeof(length));
+    entry += sizeof(length);
+    if (length > (size_t)(tableEnd - entry)) {
+        cout << "ERROR : <" << _path << "> has a corrupt element table." << endl;
+        return false;
+    }
+    stringstream quantities(string(entry, length));
+    string quantity;
+    while (getline(quantities, quantity, ','))
+        _quantities.push_back(quantity);
+
+    // Make sure all chunks that the header refers to are present
+    uint64_t chunks = (_header.samples + _header.chunkSamples - 1) / _header.chunkSamples;
+    uint64_t chunkSize = _header.chunkSamples * _header.elements * _header.quantities * sizeof(double);
+    if (_header.dataOffset + chunks * chunkSize > _size) {
+        cout << "ERROR : <" << _path << "> is truncated." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t ResultReader::getElementCount() {
+    return _header.elements;
+}
+
+uint64_t ResultReader::getSampleCount() {
+    return _header.samples;
+}
+
+uint64_t ResultReader::getFirstSample() {
+    return _header.firstSample;
+}
+
+uint64_t ResultReader::getChunkSamples() {
+    return _header.chunkSamples;
+}
+
+string ResultReader::getElementName(uint64_t element) {
+    if (element >= _names.size())
+        return "";
+    return _names[element];
+}
+
+int ResultReader::getElementPhase(uint64_t element) {
+    if (element >= _phases.size())
+        return -1;
+    return _phases[element];
+}
+
+string ResultReader::getQuantityName(int quantity) {
+    if (quantity < 0 || quantity >= _quantities.size())
+        return "";
+    return _quantities[quantity];
+}
+
+long ResultReader::findElement(string name) {
+    for (size_t i = 0; i < _names.size(); i++) {
+        if (_names[i] == name)
+            return (long) i;
+    }
+    return -1;
+}
+
+double ResultReader::getValue(uint64_t element, int quantity, uint64_t sample) {
+    if (element >= _header.elements || quantity < 0
+        || quantity >= _header.quantities || sample >= _header.samples) {
+        cout << "ERROR : Result is out of the file bounds." << endl;
+        return NAN;
+    }
+
+    uint64_t chunk = sample / _header.chunkSamples;
+    return getChunkColumn(chunk, element, quantity)[sample % _header.chunkSamples];
+}
+
+complex<double> ResultReader::getComplexValue(uint64_t element, int quantity, uint64_t sample) {
+    // Real and imaginary parts are stored next to each other
+    quantity -= quantity % 2;
+    return complex<double>(getValue(element, quantity, sample),
+                           getValue(element, quantity+1, sample));
+}
+
+void ResultReader::getColumn(uint64_t element, int quantity, uint64_t firstSample, uint64_t count, vector<double> &values) {
+    values.clear();
+
+    if (element >= _header.elements || quantity < 0
+        || quantity >= _header.quantities || firstSample >= _header.samples) {
+        cout << "ERROR : Result is out of the file bounds." << endl;
+        return;
+    }
+
+    uint64_t lastSample = min(firstSample + count, _header.samples);
+    values.reserve(lastSample - firstSample);
+
+    // Copy chunk by chunk
+    uint64_t sample = firstSample;
+    while (sample < lastSample) {
+        uint64_t chunk = sample / _header.chunkSamples;
+        uint64_t offset = sample % _header.chunkSamples;
+        uint64_t length = min(_header.chunkSamples - offset, lastSample - sample);
+
+        const double *columnStart = getChunkColumn(chunk, element, quantity) + offset;
+        values.insert(values.end(), columnStart, columnStart + length);
+        sample += length;
+    }
+}
+
+const double *ResultReader::getChunkColumn(uint64_t chunk, uint64_t element, int quantity) {
+    uint64_t chunkSize = _header.chunkSamples * _header.elements * _header.quantities;
+    uint64_t columnIndex = element * _header.quantities + quantity;
+
+    return (const double *)(_data + _header.dataOffset)
+        + chunk * chunkSize + columnIndex * _header.chunkSamples;
+}
@@ -0,0 +1,154 @@
+//
+//  resultStore.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__resultStore__
+#define __DiCOMO__resultStore__
+
+//  A binary, columnar store for time-series results. The file starts with a
+//  header that describes all elements (name and phase) and the stored
+//  quantities, followed by chunks of samples. Within each chunk every element
+//  owns one contiguous column of samples per quantity:
+//
+//      chunk 0: [e0 q0 s0..sC-1][e0 q1 s0..sC-1] ... [eN qQ s0..sC-1]
+//      chunk 1: ...
+//
+//  All chunks have the same size, so any value can be located by offset
+//  alone and the file can be mapped into memory for reading.
+
+#include "backbone.h"
+#include "trace.h"
+
+// Fixed width integers for the file layout
+#include <stdint.h>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+// Memory mapping of stored results
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define RESULT_MAGIC        "DICOMOR"
+#define RESULT_VERSION      1
+
+// Offset of the first chunk is aligned to the page size for mapping
+#define RESULT_ALIGNMENT    4096
+
+// Upper limit for the memory buffered by the writer before a chunk is flushed
+#define RESULT_CHUNK_BYTES  (64 * 1024 * 1024)
+
+// The quantities stored per element and sample, in this order
+enum resultQuantity {
+    VoltageLeftReal     = 0,
+    VoltageLeftImag     = 1,
+    VoltageRightReal    = 2,
+    VoltageRightImag    = 3,
+    CurrentReal         = 4,
+    CurrentImag         = 5,
+    PowerReal           = 6,
+    PowerImag           = 7,
+    NumberOfQuantities  = 8,
+};
+
+#define RESULT_QUANTITIES   "Re(V_l),Im(V_l),Re(V_r),Im(V_r),Re(I),Im(I),Re(S),Im(S)"
+
+// Fixed part at the very beginning of a result file
+struct resultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t quantities;
+    uint64_t elements;
+    uint64_t chunkSamples;
+    uint64_t samples;
+    uint64_t firstSample;
+    uint64_t dataOffset;
+};
+
+class ResultStore {
+protected:
+    string _path;
+    FILE *_file;
+
+    resultHeader _header;
+
+    // Values of the chunk that is currently filled
+    vector<double> _chunk;
+    uint64_t _samplesInChunk;
+
+public:
+    ResultStore(string path, uint64_t chunkSamples = 48);
+    ~ResultStore();
+
+    // Writes the header with the element description. Must be called once
+    // before any samples are appended
+    bool open(vector<string> names, vector<int> phases, uint64_t firstSample = 0);
+    bool isOpen();
+
+    // Appends one sample. The values are ordered element by element, each
+    // with NumberOfQuantities entries
+    void appendSample(const vector<double> &values);
+
+    // Writes the last chunk and the final header
+    void close();
+
+protected:
+    // Writes the buffered chunk and updates the sample count in the header
+    void flushChunk();
+};
+
+class ResultReader {
+protected:
+    string _path;
+    int _fileDescriptor;
+
+    // Mapped file
+    const char *_data;
+    size_t _size;
+
+    resultHeader _header;
+
+    // Element description read from the header
+    vector<string> _names;
+    vector<int> _phases;
+    vector<string> _quantities;
+
+public:
+    ResultReader(string path);
+    ~ResultReader();
+
+    // Maps the file and reads the header
+    bool open();
+
+    uint64_t getElementCount();
+    uint64_t getSampleCount();
+    uint64_t getFirstSample();
+    uint64_t getChunkSamples();
+
+    string getElementName(uint64_t element);
+    int getElementPhase(uint64_t element);
+    string getQuantityName(int quantity);
+
+    // Returns the element index for a name or -1 if it does not exist
+    long findElement(string name);
+
+    // Single value of an element
+    double getValue(uint64_t element, int quantity, uint64_t sample);
+    complex<double> getComplexValue(uint64_t element, int quantity, uint64_t sample);
+
+    // Copies a range of samples of one element's quantity. Only the chunks
+    // that cover the range are touched
+    void getColumn(uint64_t element, int quantity, uint64_t firstSample, uint64_t count, vector<double> &column);
+
+    // Returns the mapped column of an element's quantity within a chunk
+    // without any bounds checks
+    const double *getChunkColumn(uint64_t chunk, uint64_t element, int quantity);
+};
+
+#endif /* defined(__DiCOMO__resultStore__) */
@@ -0,0 +1,293 @@
+//
+//  sensitivity.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "sensitivity.h"
+
+Sensitivity::Sensitivity() {
+    _connections = 0;
+}
+
+bool Sensitivity::compute(Simulation *simulation) {
+    if (!simulation->hasConverged()) {
+        cout << "ERROR : Sensitivities need a solved operating point." << endl;
+        return false;
+    }
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    size_t n = simulation->getConnectionCount();
+    if (n == 0 || impedances.size() != n * 3) {
+        cout << "ERROR : Sensitivities need an assembled circuit." << endl;
+        return false;
+    }
+
+    // The return line comes first, then per phase each consumer followed by
+    // its feeder segment. Find the consumer of each connection
+    vector<size_t> consumerOf(n);
+    vector<long> previousOnPhase(n, -1);
+    vector<long> lastOnPhase(simulation->getPhases(), -1);
+    size_t index = n;
+    for (int phase = 1; phase <= simulation->getPhases(); phase++) {
+        for (size_t k = 0; k < n; k++) {
+            if (simulation->getConnectionPhase((int) k) != phase)
+                continue;
+            consumerOf[k] = index;
+            previousOnPhase[k] = lastOnPhase[phase-1];
+            lastOnPhase[phase-1] = k;
+            index += 2;
+        }
+    }
+
+    // Terminal voltages, powers drawn and their derivatives by P and Q
+    vector< complex<double> > terminals(n);
+    vector<double> powers(n), byActive(n), byReactive(n);
+    _phases.assign(n, 0);
+    _voltages.assign(n, 0.0);
+    size_t nodeBand = 2;
+    for (size_t k = 0; k < n; k++) {
+        complex<double> power = simulation->getConnectionPower((int) k);
+        double sign = (power.real() < 0.0) ? -1.0 : 1.0;
+
+        terminals[k] = leftVoltages[consumerOf[k]] - rightVoltages[consumerOf[k]];
+        powers[k] = sign * abs(power);
+        byActive[k] = (abs(power) > 0.0) ? sign * power.real() / abs(power) : 1.0;
+        byReactive[k] = (abs(power) > 0.0) ? sign * power.imag() / abs(power) : 0.0;
+
+        _phases[k] = simulation->getConnectionPhase((int) k);
+        _voltages[k] = abs(terminals[k]);
+        if (previousOnPhase[k] >= 0)
+            nodeBand = max(nodeBand, (size_t)(2*k+1 - (2*previousOnPhase[k]+1)));
+    }
+
+    // Node 2k is the return and 2k+1 the feeder node of house k, each with
+    // its real and imaginary part next to each other. Sources and sink are
+    // fixed, so they only add to the diagonal
+    size_t size = 4 * n;
+    size_t band = 2 * nodeBand + 1;
+    size_t width = 2 * band + 1;
+    vector<double> matrix(size * width, 0.0);
+
+    for (size_t k = 0; k < n; k++) {
+        size_t returnNode = 2*k;
+        size_t feederNode = 2*k + 1;
+
+        complex<double> admittance = 1.0 / ((abs(impedances[k]) != 0) ? impedances[k] : 1e-12);
+        stamp(matrix, band, returnNode, returnNode, admittance);
+        if (k > 0) {
+            stamp(matrix, band, returnNode-2, returnNode-2, admittance);
+            stamp(matrix, band, returnNode, returnNode-2, -admittance);
+            stamp(matrix, band, returnNode-2, returnNode, -admittance);
+        }
+
+        complex<double> feeder = impedances[consumerOf[k]+1];
+        admittance = 1.0 / ((abs(feeder) != 0) ? feeder : 1e-12);
+        stamp(matrix, band, feederNode, feederNode, admittance);
+        if (previousOnPhase[k] >= 0) {
+            size_t previous = 2*previousOnPhase[k] + 1;
+            stamp(matrix, band, previous, previous, admittance);
+            stamp(matrix, band, feederNode, previous, -admittance);
+            stamp(matrix, band, previous, feederNode, -admittance);
+        }
+
+        // dI_k leaves the feeder node and enters the return node. Its part
+        // in conj(dU_k) mixes the real and imaginary parts of both nodes
+        complex<double> coupling = powers[k] / pow(conj(terminals[k]), 2);
+        size_t rows[2] = {2*feederNode, 2*returnNode};
+        double signs[2] = {1.0, -1.0};
+        for (int r = 0; r < 2; r++) {
+            for (int c = 0; c < 2; c++) {
+                double sign = -signs[r] * signs[c];
+                size_t row = rows[r], column = rows[c];
+                matrix[row*width + column-row+band] += sign * coupling.real();
+                matrix[row*width + column+1-row+band] += sign * coupling.imag();
+                matrix[(row+1)*width + column-row-1+band] += sign * coupling.imag();
+                matrix[(row+1)*width + column+1-row-1+band] -= sign * coupling.real();
+            }
+        }
+    }
+
+    if (!factorBanded(matrix, size, band)) {
+        cout << "ERROR : Sensitivities could not be solved at this operating point." << endl;
+        return false;
+    }
+
+    // Change of the voltage magnitudes
+    _connections = (int) n;
+    _active.assign(n * n, 0.0);
+    _reactive.assign(n * n, 0.0);
+    vector<double> changes(size);
+    for (size_t j = 0; j < n; j++) {
+        // A unit of power drawn at house j
+        complex<double> current = 1.0 / conj(terminals[j]);
+        fill(changes.begin(), changes.end(), 0.0);
+        changes[4*j] = current.real();
+        changes[4*j+1] = current.imag();
+        changes[4*j+2] = -current.real();
+        changes[4*j+3] = -current.imag();
+        solveFactorised(matrix, changes, band, 4*j);
+
+        for (size_t k = 0; k < n; k++) {
+            complex<double> change(changes[4*k+2] - changes[4*k], changes[4*k+3] - changes[4*k+1]);
+            double magnitude = real(conj(terminals[k]) * change) / _voltages[k];
+            _active[k*n + j] = magnitude * byActive[j];
+            _reactive[k*n + j] = magnitude * byReactive[j];
+        }
+    }
+
+    return true;
+}
+
+bool Sensitivity::save(string path) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        cout << "ERROR : Could not generate <" << path << ">." << endl;
+        return false;
+    }
+
+    sensitivityHeader header;
+    memset(&header, 0, sizeof(sensitivityHeader));
+    memcpy(header.magic, SENSITIVITY_MAGIC, sizeof(header.magic));
+    header.version = SENSITIVITY_VERSION;
+    header.connections = _connections;
+    fwrite(&header, sizeof(sensitivityHeader), 1, file);
+
+    vector<int32_t> phases(_phases.begin(), _phases.end());
+    fwrite(&phases[0], sizeof(int32_t), phases.size(), file);
+    fwrite(&_voltages[0], sizeof(double), _voltages.size(), file);
+    fwrite(&_active[0], sizeof(double), _active.size(), file);
+    fwrite(&_reactive[0], sizeof(double), _reactive.size(), file);
+    fclose(file);
+
+    cout << " File successfully written to:" << endl << path << endl;
+    return true;
+}
+
+bool Sensitivity::load(string path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        cout << "ERROR : Could not open <" << path << ">." << endl;
+        return false;
+    }
+
+    sensitivityHeader header;
+    if (fread(&header, sizeof(sensitivityHeader), 1, file) != 1
+        || memcmp(header.magic, SENSITIVITY_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SENSITIVITY_VERSION || header.connections == 0) {
+        cout << "ERROR : <" << path << "> is not a sensitivity file." << endl;
+        fclose(file);
+        return false;
+    }
+
+    size_t n = header.connections;
+    vector<int32_t> phases(n);
+    _voltages.resize(n);
+    _active.resize(n * n);
+    _reactive.resize(n * n);
+    bool complete = (fread(&phases[0], sizeof(int32_t), n, file) == n
+                     && fread(&_voltages[0], sizeof(double), n, file) == n
+                     && fread(&_active[0], sizeof(double), n * n, file) == n * n
+                     && fread(&_reactive[0], sizeof(double), n * n, file) == n * n);
+    fclose(file);
+
+    if (!complete) {
+        cout << "ERROR : <" << path << "> is incomplete." << endl;
+        _connections = 0;
+        return false;
+    }
+
+    _phases.assign(phases.begin(), phases.end());
+    _connections = (int) n;
+    return true;
+}
+
+int Sensitivity::getConnectionCount() {
+    return _connections;
+}
+
+double Sensitivity::getVoltage(int connection) {
+    if (connection < 0 || connection >= _connections)
+        return NAN;
+    return _voltages[connection];
+}
+
+double Sensitivity::getActive(int row, int column) {
+    if (row < 0 || row >= _connections || column < 0 || column >= _connections)
+        return NAN;
+    return _active[row*_connections + column];
+}
+
+double Sensitivity::getReactive(int row, int column) {
+    if (row < 0 || row >= _connections || column < 0 || column >= _connections)
+        return NAN;
+    return _reactive[row*_connections + column];
+}
+
+bool Sensitivity::predict(const vector< complex<double> > &powerDeltas, vector<double> &voltages) {
+    if (powerDeltas.size() != _connections) {
+        cout << "ERROR : Expected <" << _connections << "> power changes, not <" << powerDeltas.size() << ">" << endl;
+        return false;
+    }
+
+    voltages = _voltages;
+    for (int k = 0; k < _connections; k++)
+        for (int j = 0; j < _connections; j++)
+            voltages[k] += _active[k*_connections + j] * powerDeltas[j].real()
+                         + _reactive[k*_connections + j] * powerDeltas[j].imag();
+
+    return true;
+}
+
+#pragma mark PROTECTED
+
+void Sensitivity::stamp(vector<double> &matrix, size_t band, size_t row, size_t column, complex<double> value) {
+    // Real and imaginary rows of the node, each against both parts of the
+    // column node
+    size_t width = 2 * band + 1;
+    size_t real = 2*row, imaginary = 2*row + 1;
+    matrix[real*width + 2*column-real+band] += value.real();
+    matrix[real*width + 2*column+1-real+band] -= value.imag();
+    matrix[imaginary*width + 2*column-imaginary+band] += value.imag();
+    matrix[imaginary*width + 2*column+1-imaginary+band] += value.real();
+}
+
+bool Sensitivity::factorBanded(vector<double> &matrix, size_t size, size_t band) {
+    size_t width = 2 * band + 1;
+    for (size_t i = 0; i < size; i++) {
+        double pivot = matrix[i*width + band];
+        if (pivot == 0.0 || pivot != pivot)
+            return false;
+        for (size_t j = i+1; j <= min(size-1, i+band); j++) {
+            double factor = matrix[j*width + i-j+band] / pivot;
+            matrix[j*width + i-j+band] = factor;
+            if (factor == 0.0)
+                continue;
+            for (size_t c = i+1; c <= min(size-1, i+band); c++)
+                matrix[j*width + c-j+band] -= factor * matrix[i*width + c-i+band];
+        }
+    }
+    return true;
+}
+
+void Sensitivity::solveFactorised(const vector<double> &factors, vector<double> &rightHandSide, size_t band, size_t firstRow) {
+    size_t size = rightHandSide.size();
+    size_t width = 2 * band + 1;
+
+    for (size_t i = firstRow; i < size; i++) {
+        if (rightHandSide[i] == 0.0)
+            continue;
+        for (size_t j = i+1; j <= min(size-1, i+band); j++)
+            rightHandSide[j] -= factors[j*width + i-j+band] * rightHandSide[i];
+    }
+
+    for (size_t i = size; i-- > 0;) {
+        for (size_t c = i+1; c <= min(size-1, i+band); c++)
+            rightHandSide[i] -= factors[i*width + c-i+band] * rightHandSide[c];
+        rightHandSide[i] /= factors[i*width + band];
+    }
+}
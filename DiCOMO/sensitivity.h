@@ -0,0 +1,93 @@
+//
+//  sensitivity.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__sensitivity__
+#define __DiCOMO__sensitivity__
+
+//  Linear sensitivity of the voltage magnitude at every house to the real and
+//  reactive power of every house, taken at a solved operating point.
+//
+//  A consumer draws its apparent power |S| as a resistance, so its current
+//  is I_k = P_k / conj(U_k) with P_k = +-|S_k| and U_k the voltage across it.
+//  Linearising this around the operating point gives
+//
+//      dI_k = dP_k / conj(U_k) - P_k conj(dU_k) / conj(U_k)^2
+//
+//  which, with the nodal equations of the segments, is one system in the
+//  changes of the node voltages. As conj(dU) is not linear in dU, real and
+//  imaginary parts are separate unknowns. The system keeps the banded
+//  pattern of the reference solver, so it is factorised once within the
+//  band and solved for a unit change of every house, starting from the
+//  first row that house touches. Reactive power only acts through the
+//  apparent power of its house.
+//
+//  The matrices are stored as a binary file:
+//
+//      header | phases (int32) | voltages | dV/dP | dV/dQ (double, row major)
+
+#include "simulation.h"
+
+#define SENSITIVITY_MAGIC       "DICOMOV"
+#define SENSITIVITY_VERSION     1
+
+// Fixed part at the very beginning of a sensitivity file
+struct sensitivityHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t connections;
+};
+
+class Sensitivity {
+protected:
+    int _connections;
+
+    // Phase and voltage magnitude of every house at the operating point
+    vector<int> _phases;
+    vector<double> _voltages;
+
+    // Row k, column j is the change of the voltage at house k in V per W
+    // (or var) at house j
+    vector<double> _active;
+    vector<double> _reactive;
+
+public:
+    Sensitivity();
+
+    // Computes the matrices at the current solution of the simulation
+    bool compute(Simulation *simulation);
+
+    bool save(string path);
+    bool load(string path);
+
+    int getConnectionCount();
+    double getVoltage(int connection);
+    double getActive(int row, int column);
+    double getReactive(int row, int column);
+
+    // Voltage magnitudes of all houses after the given change of their
+    // powers, in connection order
+    bool predict(const vector< complex<double> > &powerDeltas, vector<double> &voltages);
+
+protected:
+    // Adds a complex admittance between a row and a column node to a banded
+    // real system
+    static void stamp(vector<double> &matrix, size_t band, size_t row, size_t column, complex<double> value);
+
+    // LU factorisation of a banded system of the given size and half
+    // bandwidth in place, keeping the multipliers. The nodal matrix is
+    // diagonally dominant, so no pivoting is needed. Returns false if a
+    // pivot vanishes
+    static bool factorBanded(vector<double> &matrix, size_t size, size_t band);
+
+    // Solves a factorised banded system for one right hand side that is
+    // zero before the first row
+    static void solveFactorised(const vector<double> &factors, vector<double> &rightHandSide, size_t band, size_t firstRow);
+};
+
+#endif /* defined(__DiCOMO__sensitivity__) */
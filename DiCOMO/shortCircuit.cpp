@@ -0,0 +1,236 @@
+//
+//  shortCircuit.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "shortCircuit.h"
+
+ShortCircuit::ShortCircuit() {
+    _connections = 0;
+    _faultImpedance = 0.0;
+    _band = 2;
+    _factorisationTime = 0.0;
+    _faultTime = 0.0;
+}
+
+void ShortCircuit::setFaultImpedance(complex<double> impedance) {
+    _faultImpedance = impedance;
+}
+
+bool ShortCircuit::compute(Simulation *simulation) {
+    typedef complex<long double> complexLong;
+
+    if (!simulation->hasConverged()) {
+        cout << "ERROR : Short circuits need a solved operating point." << endl;
+        return false;
+    }
+
+    vector< complex<double> > leftVoltages, rightVoltages, currents, impedances;
+    simulation->getElementStates(leftVoltages, rightVoltages, currents, impedances);
+
+    size_t n = simulation->getConnectionCount();
+    if (n == 0 || impedances.size() != n * 3) {
+        cout << "ERROR : Short circuits need an assembled circuit." << endl;
+        return false;
+    }
+
+    double startTime = Metrics::now();
+
+    // The return line comes first, then per phase each consumer followed by
+    // its feeder segment. Find the consumer of each connection
+    vector<size_t> consumerOf(n);
+    vector<long> previousOnPhase(n, -1);
+    vector<long> lastOnPhase(simulation->getPhases(), -1);
+    size_t index = n;
+    for (int phase = 1; phase <= simulation->getPhases(); phase++) {
+        for (size_t k = 0; k < n; k++) {
+            if (simulation->getConnectionPhase((int) k) != phase)
+                continue;
+            consumerOf[k] = index;
+            previousOnPhase[k] = lastOnPhase[phase-1];
+            lastOnPhase[phase-1] = k;
+            index += 2;
+        }
+    }
+
+    _connections = (int) n;
+    _phases.assign(n, 0);
+    _band = 2;
+    for (size_t k = 0; k < n; k++) {
+        _phases[k] = simulation->getConnectionPhase((int) k);
+        if (previousOnPhase[k] >= 0)
+            _band = max(_band, (size_t)(2*k+1 - (2*previousOnPhase[k]+1)));
+    }
+
+    // Nodal matrix of the segments and the frozen consumers. Sources and
+    // sink are fixed, so they only add to the diagonal
+    size_t nodes = 2 * n;
+    size_t width = 2 * _band + 1;
+    _factors.assign(nodes * width, 0.0L);
+    _voltages.assign(nodes, 0.0L);
+    for (size_t k = 0; k < n; k++) {
+        size_t returnNode = 2*k;
+        size_t feederNode = 2*k + 1;
+
+        complexLong impedance(impedances[k].real(), impedances[k].imag());
+        complexLong admittance = 1.0L / ((abs(impedance) != 0) ? impedance : 1e-12L);
+        _factors[returnNode*width + _band] += admittance;
+        if (k > 0) {
+            _factors[(returnNode-2)*width + _band] += admittance;
+            _factors[returnNode*width + _band-2] -= admittance;
+            _factors[(returnNode-2)*width + _band+2] -= admittance;
+        }
+
+        impedance = complexLong(impedances[consumerOf[k]+1].real(), impedances[consumerOf[k]+1].imag());
+        admittance = 1.0L / ((abs(impedance) != 0) ? impedance : 1e-12L);
+        _factors[feederNode*width + _band] += admittance;
+        if (previousOnPhase[k] >= 0) {
+            size_t previous = 2*previousOnPhase[k] + 1;
+            size_t distance = feederNode - previous;
+            _factors[previous*width + _band] += admittance;
+            _factors[feederNode*width + _band-distance] -= admittance;
+            _factors[previous*width + _band+distance] -= admittance;
+        }
+
+        double load = impedances[consumerOf[k]].real();
+        if (load != INFINITY && load != 0.0) {
+            admittance = 1.0L / (long double) load;
+            _factors[feederNode*width + _band] += admittance;
+            _factors[returnNode*width + _band] += admittance;
+            _factors[feederNode*width + _band-1] -= admittance;
+            _factors[returnNode*width + _band+1] -= admittance;
+        }
+
+        _voltages[returnNode] = complexLong(rightVoltages[consumerOf[k]].real(), rightVoltages[consumerOf[k]].imag());
+        _voltages[feederNode] = complexLong(leftVoltages[consumerOf[k]].real(), leftVoltages[consumerOf[k]].imag());
+    }
+
+    // LU factorisation within the band, keeping the multipliers. The matrix
+    // is diagonally dominant, so no pivoting is needed
+    for (size_t i = 0; i < nodes; i++) {
+        complexLong pivot = _factors[i*width + _band];
+        for (size_t j = i+1; j <= min(nodes-1, i+_band); j++) {
+            complexLong factor = _factors[j*width + i-j+_band] / pivot;
+            _factors[j*width + i-j+_band] = factor;
+            if (factor == 0.0L)
+                continue;
+            for (size_t c = i+1; c <= min(nodes-1, i+_band); c++)
+                _factors[j*width + c-j+_band] -= factor * _factors[i*width + c-i+_band];
+        }
+    }
+    _factorisationTime = Metrics::now() - startTime;
+
+    startTime = Metrics::now();
+    _faults.assign(n, shortCircuitFault());
+    for (size_t k = 0; k < n; k++) {
+        if (!computeFault((int) k, _faults[k])) {
+            cout << "ERROR : Fault at connection " << k << " could not be computed." << endl;
+            return false;
+        }
+    }
+    _faultTime = Metrics::now() - startTime;
+
+    size_t weakest = 0;
+    for (size_t k = 1; k < n; k++)
+        if (abs(_faults[k].current) < abs(_faults[weakest].current))
+            weakest = k;
+
+    cout << "Faults :" << setw(21) << n << " in " << fixed << setprecision(3) << _faultTime * 1000 << " ms";
+    cout << " (factorised in " << _factorisationTime * 1000 << " ms)" << endl;
+    cout << "Lowest fault current :" << setw(7) << setprecision(1) << abs(_faults[weakest].current) << " A at connection " << weakest << endl;
+
+    return true;
+}
+
+bool ShortCircuit::save(string path) {
+    string file = path + "_faults.csv";
+    ofstream output(file.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << file << ">." << endl;
+        return false;
+    }
+
+    output << "Connection,Phase,Pre-fault (V),Resistance (Ohm),Reactance (Ohm),Current (A),Angle (deg),";
+    output << "Neutral shift (V),Lowest other (V),Highest other (V)" << endl;
+    for (size_t k = 0; k < _faults.size(); k++) {
+        shortCircuitFault &fault = _faults[k];
+        output << k << "," << _phases[k] << "," << setprecision(10) << fault.preFault << ",";
+        output << fault.impedance.real() << "," << fault.impedance.imag() << ",";
+        output << abs(fault.current) << "," << arg(fault.current) * 180.0 / M_PI << ",";
+        output << fault.neutral << "," << fault.lowest << "," << fault.highest << endl;
+    }
+    output.close();
+
+    cout << " File successfully written to:" << endl << file << endl;
+    return true;
+}
+
+bool ShortCircuit::computeFault(int connection, shortCircuitFault &fault, vector< complex<double> > *voltages) {
+    typedef complex<long double> complexLong;
+
+    if (connection < 0 || connection >= _connections || _factors.empty())
+        return false;
+
+    // Difference of the columns of the fault's feeder and return node
+    size_t returnNode = 2*connection;
+    size_t feederNode = 2*connection + 1;
+    vector<complexLong> transfer(2 * _connections, 0.0L);
+    transfer[feederNode] = 1.0L;
+    transfer[returnNode] = -1.0L;
+    solveFactorised(transfer, returnNode);
+
+    complexLong impedance = transfer[feederNode] - transfer[returnNode];
+    complexLong total = impedance + complexLong(_faultImpedance.real(), _faultImpedance.imag());
+    if (abs(total) == 0 || total != total)
+        return false;
+
+    complexLong preFault = _voltages[feederNode] - _voltages[returnNode];
+    complexLong current = preFault / total;
+
+    fault.current = complex<double>(current);
+    fault.impedance = complex<double>(impedance);
+    fault.preFault = (double) abs(preFault);
+    fault.neutral = (double) abs(transfer[returnNode] * current);
+    fault.lowest = (_connections > 1) ? INFINITY : NAN;
+    fault.highest = (_connections > 1) ? 0.0 : NAN;
+
+    // Superposition of the fault current onto the operating point
+    for (int k = 0; k < _connections; k++) {
+        if (k == connection)
+            continue;
+        double voltage = (double) abs(_voltages[2*k+1] - transfer[2*k+1] * current - _voltages[2*k] + transfer[2*k] * current);
+        fault.lowest = min(fault.lowest, voltage);
+        fault.highest = max(fault.highest, voltage);
+    }
+
+    if (voltages) {
+        voltages->resize(transfer.size());
+        for (size_t i = 0; i < transfer.size(); i++)
+            (*voltages)[i] = complex<double>(_voltages[i] - transfer[i] * current);
+    }
+
+    return true;
+}
+
+#pragma mark PROTECTED
+
+void ShortCircuit::solveFactorised(vector< complex<long double> > &rightHandSide, size_t firstRow) {
+    size_t nodes = rightHandSide.size();
+    size_t width = 2 * _band + 1;
+
+    for (size_t i = firstRow; i < nodes; i++) {
+        if (rightHandSide[i] == 0.0L)
+            continue;
+        for (size_t j = i+1; j <= min(nodes-1, i+_band); j++)
+            rightHandSide[j] -= _factors[j*width + i-j+_band] * rightHandSide[i];
+    }
+
+    for (size_t i = nodes; i-- > 0;) {
+        for (size_t c = i+1; c <= min(nodes-1, i+_band); c++)
+            rightHandSide[i] -= _factors[i*width + c-i+_band] * rightHandSide[c];
+        rightHandSide[i] /= _factors[i*width + _band];
+    }
+}
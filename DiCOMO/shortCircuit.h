@@ -0,0 +1,86 @@
+//
+//  shortCircuit.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__shortCircuit__
+#define __DiCOMO__shortCircuit__
+
+//  Line-to-neutral faults at the feeder node of every house, from a solved
+//  operating point. The consumers are frozen as the resistances they have at
+//  that point, so the network is linear and its nodal matrix is factorised
+//  once. A fault between feeder node f and return node r of a house then
+//  needs a single solve for the current source e_f - e_r:
+//
+//      x = Z (e_f - e_r)
+//      Z_th = x_f - x_r
+//      I_f = (V_f - V_r) / (Z_th + Z_fault)
+//      V' = V - x I_f
+//
+//  which gives the driving-point impedance of the fault, its current and,
+//  by superposition, the post-fault voltage of every node. With the banded
+//  factors each fault costs time linear in the length of the feeder.
+//
+//  Nodes are numbered like the reference solver: node 2k is the return node
+//  of connection k and node 2k+1 its feeder node.
+
+#include "simulation.h"
+
+// A fault at one house and what the feeder sees during it
+struct shortCircuitFault {
+    complex<double> current;    // into the fault in A
+    complex<double> impedance;  // driving-point impedance of the fault in Ohm
+    double preFault;            // voltage across the house before the fault
+    double neutral;             // rise of the return node at the fault
+    double lowest;              // lowest voltage at any other house
+    double highest;             // highest voltage at any other house
+};
+
+class ShortCircuit {
+protected:
+    int _connections;
+    vector<int> _phases;
+
+    // Impedance of the fault itself, zero for a bolted fault
+    complex<double> _faultImpedance;
+
+    // LU factors of the nodal matrix, element (i, j) stored at
+    // i*(2*band+1) + j-i+band with the multipliers below the diagonal
+    vector< complex<long double> > _factors;
+    size_t _band;
+
+    // Node voltages at the operating point
+    vector< complex<long double> > _voltages;
+
+    vector<shortCircuitFault> _faults;
+
+    // Time of the factorisation and of all faults in s
+    double _factorisationTime;
+    double _faultTime;
+
+public:
+    ShortCircuit();
+
+    void setFaultImpedance(complex<double> impedance);
+
+    // Factorises the network at the current solution of the simulation and
+    // computes the fault at every house
+    bool compute(Simulation *simulation);
+
+    // Writes one row per house as CSV
+    bool save(string path);
+
+    // Fault at one house, and optionally the post-fault voltage of every
+    // node. Needs a factorised network
+    bool computeFault(int connection, shortCircuitFault &fault, vector< complex<double> > *voltages = NULL);
+
+protected:
+    // Solves the factorised system in place for a right hand side that is
+    // zero before the given row
+    void solveFactorised(vector< complex<long double> > &rightHandSide, size_t firstRow);
+};
+
+#endif /* defined(__DiCOMO__shortCircuit__) */
@@ -18,12 +18,46 @@ Simulation::Simulation(bool verbose) {
     setPhases(1);
     
     _verbose = verbose;
+    _silent = false;
+    _metrics = NULL;
+    _solver = InterrogationSolver;
+    _voltageCeiling = 0.0;
+    _progress = NULL;
+    _converged = false;
+    memset(&_screening, 0, sizeof(screeningStatistics));
+}
+
+Simulation::Simulation(Simulation *setup) {
+    // Take over the entire setup but not the circuit
+    _feederImpedances = setup->_feederImpedances;
+    _phases = setup->_phases;
+    _maxPhases = setup->_maxPhases;
+    _minPhases = setup->_minPhases;
+    _vcc = setup->_vcc;
+    _vss = setup->_vss;
+    _returnImpedances = setup->_returnImpedances;
+    _connectionOrder = setup->_connectionOrder;
+    _powers = setup->_powers;
+    
+    _verbose = false;
+    _silent = true;
+    _metrics = NULL;
+    _solver = setup->_solver;
+    _voltageCeiling = setup->_voltageCeiling;
+    _progress = NULL;
+    _converged = false;
+    memset(&_screening, 0, sizeof(screeningStatistics));
 }
 
 Simulation::~Simulation() {
     // Clean up simulation
+    while (!_circuit.empty()) {
+        delete _circuit.back();
+        _circuit.pop_back();
+    }
     
-    cout << SPACER << endl << BYE << endl << END_SPACER << endl;
+    if (!_silent)
+        cout << SPACER << endl << BYE << endl << END_SPACER << endl;
 }
 
 void Simulation::setPhases(int phases) {
@@ -60,6 +94,43 @@ void Simulation::setPhases(int phases) {
     _connectionOrder.clear();
 }
 
+void Simulation::setMetrics(Metrics *metrics) {
+    _metrics = metrics;
+}
+
+Metrics *Simulation::getMetrics() {
+    return _metrics;
+}
+
+void Simulation::setProgress(ProgressReporter *progress) {
+    _progress = progress;
+}
+
+void Simulation::setSolver(int solver) {
+    if (solver < 0 || solver >= NumberOfSolvers) {
+        cout << "ERROR : Unknown solver <" << solver << ">" << endl;
+        return;
+    }
+    _solver = solver;
+}
+
+int Simulation::getSolver() {
+    return _solver;
+}
+
+void Simulation::setVoltageCeiling(double ceiling) {
+    _voltageCeiling = max(0.0, ceiling);
+}
+
+const char *Simulation::solverName(int solver) {
+    switch (solver) {
+        case InterrogationSolver:   return "interrogation";
+        case ReferenceSolver:       return "reference";
+        case LinearSolver:          return "linear";
+        default:                    return "unknown";
+    }
+}
+
 int Simulation::getPhases() {
     if (_phases == 0)
         setPhases(1);
@@ -90,6 +161,14 @@ void Simulation::setSink(complex<double> vss) {
     _vss = vss;
 }
 
+complex<double> Simulation::getSource() {
+    return _vcc;
+}
+
+complex<double> Simulation::getSink() {
+    return _vss;
+}
+
 void Simulation::addFeederImpedanceForPhase(complex<double> impedance, int phase) {
     // Ensure only relevant data is stored
     if (!phaseOK(phase)) return;
@@ -134,10 +213,60 @@ void Simulation::addPowerToPhase(double power, double powerFactor, int phase, bo
     addPowerToPhase(complex<double>(truePower, reactivePower), phase);
 }
 
+void Simulation::clearPowers() {
+    // Empty each phase's powers but keep the number of columns
+    for (int i = 0; i < _powers.size(); i++)
+        _powers[i].clear();
+    
+    _connectionOrder.clear();
+}
+
+int Simulation::getConnectionCount() {
+    return (int) _connectionOrder.size();
+}
+
+int Simulation::getConnectionPhase(int connection) {
+    if (connection < 0 || connection >= _connectionOrder.size())
+        return 0;
+    return _connectionOrder[connection];
+}
+
+complex<double> Simulation::getConnectionPower(int connection) {
+    int phase = getConnectionPhase(connection);
+    if (phase == 0)
+        return complex<double> (0.0, 0.0);
+    
+    // Position of the connection among those of its phase
+    int index = (int) count(_connectionOrder.begin(), _connectionOrder.begin() + connection, phase);
+    return _powers[phase-1][index];
+}
+
+void Simulation::setConnectionPower(int connection, complex<double> power) {
+    int phase = getConnectionPhase(connection);
+    if (phase == 0) {
+        cout << "ERROR : Connection <" << connection << "> does not exist" << endl;
+        return;
+    }
+    
+    int index = (int) count(_connectionOrder.begin(), _connectionOrder.begin() + connection, phase);
+    _powers[phase-1][index] = power;
+}
+
 void Simulation::start() {
+    // Only assemble and evaluate a valid setup
+    if (!validate())
+        return;
+    
+    assemble();
+    solve();
+}
+
+bool Simulation::validate() {
     
 #pragma mark CHECKING EVERYTHING IS FINE
-    cout << "CHECKING EVERYTHING IS FINE" << endl << endl;
+    MetricsTimer timer(_metrics, ValidationTimer);
+    TraceSpan span("validate");
+    if (!_silent) cout << "CHECKING EVERYTHING IS FINE" << endl << endl;
     
     // Check whether the branches match
     int totalNumberOfFeederImpedances = 0;
@@ -169,7 +298,7 @@ void Simulation::start() {
             cout << "F           = " << _feederImpedances[i].size() << endl;
             cout << "P           = " << _powers[i].size() << endl;
             cout << "Connections = " << totalNumberOfConnectionsOnPhase << endl;
-            return;
+            return false;
         }
         
         if (_verbose) cout << "Phase :" << setw(48) << i+1 << " OK" << endl;
@@ -186,36 +315,52 @@ void Simulation::start() {
         cout << "R           = " << _returnImpedances.size() << endl;
         cout << "P           = " << totalNummerOfPowers << endl;
         cout << "Connections = " << _connectionOrder.size() << endl;
-        return;
+        return false;
     }
     if (_verbose) cout << "Components match :" << setw(40) << " OK" << endl;
     
-    
+    return true;
+}
+
+void Simulation::assemble() {
     // Start connecting
 #pragma mark ASSEMBLING CIRCUIT
+    MetricsTimer timer(_metrics, AssemblyTimer);
+    TraceSpan span("assemble");
+    MemoryStageScope stage(AssembleStage);
     if (_verbose) cout << endl << SPACER << endl;
-    cout << "ASSEMBLING CIRCUIT" << endl << endl;
+    if (!_silent) cout << "ASSEMBLING CIRCUIT" << endl << endl;
     
     // Empty the current circuit and generate a vector through which the
-    // algorithm can enter the computation
-    _circuit.clear();
-    vector<Element *> entryElements;
+    // algorithm can enter the computation. Deleting the previous elements
+    // also frees their indices, so a rebuilt circuit keeps its element names
+    while (!_circuit.empty()) {
+        delete _circuit.back();
+        _circuit.pop_back();
+    }
+    _referenceVoltages.clear();
+    _elementPhases.clear();
+    _entryElements.clear();
+    _assembledOrder = _connectionOrder;
+    _assembledCounts.assign(_phases, 0);
+    for (size_t i = 0; i < _connectionOrder.size(); i++)
+        if (_connectionOrder[i] >= 1 && _connectionOrder[i] <= _phases)
+            _assembledCounts[_connectionOrder[i]-1]++;
+    vector<Element *> &entryElements = _entryElements;
+    
+    // Reserve the entire circuit, so the memory of each element can be
+    // told apart from that of a growing vector
+    _circuit.reserve(_returnImpedances.size() * 3);
+    _elementPhases.reserve(_returnImpedances.size() * 3);
     
     // Connect entire return line first since it is phase independent and
     // a continuous connection
     for (int i = 0; i < _returnImpedances.size(); i++) {
         // Compute the rotated voltage source for the current phase
-        double angle = (double)(2 * M_PI / _phases);
-        double offset = (double)tan(_vcc.imag() / _vcc.real());
-        if (offset == 0.0 && _vcc.real() < 0)
-            offset = M_PI;
-        
-        double real = abs(_vcc) * cos(angle * (_connectionOrder[i]-1) + offset);
-        double imag = abs(_vcc) * sin(angle * (_connectionOrder[i]-1) + offset);
-        
-        complex<double> phaseVcc = complex<double> (real, imag);
+        complex<double> phaseVcc = phaseSource(_connectionOrder[i]);
         
         // Set up new impedance
+        long memory = MemoryTracker::threadBytes();
         Resistor *r = new Resistor(phaseVcc, _vss);
         r->setImpedance(_returnImpedances[i]);
 
@@ -241,6 +386,8 @@ void Simulation::start() {
         }
         // Insert into circuit
         _circuit.push_back( r );
+        _elementPhases.push_back(0);
+        MemoryTracker::addElement(RESISTOR, memory);
     }
     
     // Connect one phase at a time to the return line
@@ -254,17 +401,10 @@ void Simulation::start() {
             
             if (_connectionOrder[elementsCounter] == currentPhase+1) {
                 // Compute the rotated voltage source for the current phase
-                double angle = (double)(2 * M_PI / _phases);
-                double offset = (double)tan(_vcc.imag() / _vcc.real());
-                if (offset == 0.0 && _vcc.real() < 0)
-                    offset = M_PI;
-                
-                double real = abs(_vcc) * cos(angle * currentPhase + offset);
-                double imag = abs(_vcc) * sin(angle * currentPhase + offset);
-                
-                complex<double> phaseVcc = complex<double> (real, imag);
+                complex<double> phaseVcc = phaseSource(currentPhase+1);
                 
                 // Create consumer
+                long memory = MemoryTracker::threadBytes();
                 Consumer *c = new Consumer(phaseVcc, _vss);
                 // Set its power consumption
                 c->setPower(_powers[currentPhase][connectionsPerPhase]);
@@ -277,8 +417,11 @@ void Simulation::start() {
                 }
                 // Insert into circuit
                 _circuit.push_back(c);
+                _elementPhases.push_back(currentPhase+1);
+                MemoryTracker::addElement(CONSUMER, memory);
                 
                 // Create feeder
+                memory = MemoryTracker::threadBytes();
                 Resistor *f = new Resistor(phaseVcc, _vss);
                 // Set its impedance
                 f->setImpedance(_feederImpedances[currentPhase][connectionsPerPhase]);
@@ -293,7 +436,7 @@ void Simulation::start() {
                     if (_verbose) {
                         cout << "Connecting feeder line element to source:" << setw(17) << f->elementName() << endl;
                         cout << " > " << setw(10) << abs(_vcc) << " V";
-                        cout << " @ " << setw(3) << angle*currentPhase*180/M_PI << "°";
+                        cout << " @ " << setw(3) << 360.0/_phases*currentPhase << "°";
                         cout << " on phase " << setw(3) << currentPhase << endl;
                     }
                     f->setPortParameter(PORT_L, VOLTAGE, phaseVcc);
@@ -304,6 +447,8 @@ void Simulation::start() {
                 }
                 // Insert into circuit
                 _circuit.push_back(f);
+                _elementPhases.push_back(currentPhase+1);
+                MemoryTracker::addElement(RESISTOR, memory);
                 
                 lastPhaseConnection = elementsCounter;
                 // Increase phase connection counter
@@ -313,10 +458,60 @@ void Simulation::start() {
         }
     }
     
+}
+
+void Simulation::solve() {
+    // Make sure there is something to evaluate
+    if (_circuit.empty()) {
+        cout << "ERROR : No circuit has been set up." << endl;
+        return;
+    }
+    
+    MetricsTimer timer(_metrics, SolveTimer);
+    TraceSpan span("solve");
+    MemoryStageScope stage(SolveStage);
+    
     // Start execution
 #pragma makr STARTING EVALUATION
     if (_verbose) cout << endl << SPACER << endl;
-    cout << "STARTING EVALUATION" << endl << endl;
+    if (!_silent) cout << "STARTING EVALUATION" << endl << endl;
+    
+    switch (_solver) {
+        case ReferenceSolver:
+            solveReference();
+            break;
+        case LinearSolver:
+            solveLinear();
+            screenLinear();
+            break;
+        default:
+            solveInterrogation();
+            break;
+    }
+    
+    // Show results, one block per element is only affordable when debugging
+    if (_verbose && LOG_ENABLED(LogDebug)) {
+        cout << endl << SPACER << endl;
+        cout << "RESULTS" << endl << endl;
+        
+        for (int i = 0; i < _circuit.size(); i++) {
+            cout << setw(19) << _circuit[i]->elementName();
+            cout << "         _____" << endl;
+            cout << setw(19) << _circuit[i]->getPortParameter(PORT_L, VOLTAGE) << " V";
+            cout << "   ___|     |___";
+            cout << setw(19) << _circuit[i]->getPortParameter(PORT_R, VOLTAGE) << " V" << endl;
+            cout << setw(19) << _circuit[i]->getPortParameter(PORT_L, CURRENT) << " A";
+            cout << "      |_____|   ";
+            cout << setw(19) << _circuit[i]->getPortParameter(PORT_R, CURRENT) << " A" << endl << endl;
+        }
+    }
+}
+
+void Simulation::solveInterrogation() {
+    vector<Element *> &entryElements = _entryElements;
+    
+    // Elements report their impedance recursions to the metrics
+    Metrics::activate(_metrics);
     
     // Reverse order, so that feeder lines are evaluated first and common
     // return line last
@@ -325,18 +520,23 @@ void Simulation::start() {
     if (_verbose) cout << "Executing " << _returnImpedances.size()*3 << " iterations" << endl << endl;
     
     vector<Element *> computationBuffer;
-    clock_t startTime = clock();
+    double startTime = Metrics::now();
+    
+    // Counted locally and only passed on to the metrics at the end
+    long stateUpdates = 0;
+    size_t worklistPeak = 0;
+    int iterationsToConvergence = 0;
+    vector< complex<double> > previousVoltages;
     
     // Times executions by 3 since each "branch" contains 3 elements:
     // > feeder, consumer/storage, return
     for (int execution = 0; execution < _returnImpedances.size()*3; execution++) {
         computationBuffer = entryElements;
         
-        if (_verbose) {
-
+        // Per pass output is kept out of release builds
+        if (_verbose && LOG_ENABLED(LogTrace)) {
             cout << "Computing :    " << setw(3) << (int)(execution / (_returnImpedances.size()*3.0) * 100.0) << "%";
-            clock_t nowTime = clock();
-            cout << "         |           Time:" << setw(10) << fixed << setprecision(2) << (((float)nowTime - (float)startTime) / 1000000.0F ) * 1000 << " ms" << endl;
+            cout << "         |           Time:" << setw(10) << fixed << setprecision(2) << (Metrics::now() - startTime) * 1000 << " ms" << endl;
         }
         
         do {
@@ -353,36 +553,443 @@ void Simulation::start() {
                                      nextInterrogators.begin(),
                                      nextInterrogators.end());
             
+            stateUpdates++;
+            worklistPeak = max(worklistPeak, computationBuffer.size());
+            
         } while (!computationBuffer.empty());
+        
+        // The last iteration that still changed a voltage marks convergence
+        if (_metrics && voltagesChanged(previousVoltages))
+            iterationsToConvergence = execution + 1;
+        
+        if (_progress)
+            _progress->advance();
     }
     
-    cout << "Computing :    100%";
-    clock_t nowTime = clock();
-    cout << "         |           Time:" << setw(10) << fixed << setprecision(2) << (((float)nowTime - (float)startTime) / 1000000.0F ) * 1000 << " ms" << endl << endl;
+    Metrics::activate(NULL);
     
+    // The interrogation always runs its full number of passes
+    _converged = true;
     
-    // Show results
-    if (_verbose) {
-        cout << endl << SPACER << endl;
-        cout << "RESULTS" << endl << endl;
+    if (_metrics) {
+        _metrics->count(SolveCounter);
+        _metrics->count(StateUpdateCounter, stateUpdates);
+        _metrics->count(WorklistPeakCounter, worklistPeak);
+        _metrics->count(IterationCounter, _returnImpedances.size()*3);
+        _metrics->count(ConvergenceCounter, iterationsToConvergence);
+    }
+    
+    if (!_silent) {
+        cout << "Computing :    100%";
+        cout << "         |           Time:" << setw(10) << fixed << setprecision(2) << (Metrics::now() - startTime) * 1000 << " ms" << endl << endl;
+    }
+}
+
+bool Simulation::collectBranches(vector<size_t> &consumerOf, vector<long> &previousOnPhase, vector< complex<long double> > &returnImpedances, vector< complex<long double> > &feederImpedances, vector<long double> &powers) {
+    typedef complex<long double> complexLong;
+    
+    size_t length = _returnImpedances.size();
+    if (_connectionOrder.size() != length || _circuit.size() != length * 3)
+        return false;
+    
+    // Node 2k is the return line node of connection k (left of return line
+    // segment k), node 2k+1 the feeder node its consumer hangs from. Find the
+    // consumer of each connection and the previous connection on its phase
+    consumerOf.assign(length, 0);
+    previousOnPhase.assign(length, -1);
+    vector<long> lastOnPhase(_phases, -1);
+    size_t index = length;
+    for (int phase = 0; phase < _phases; phase++) {
+        for (size_t k = 0; k < length; k++) {
+            if (_connectionOrder[k] != phase+1)
+                continue;
+            consumerOf[k] = index;
+            previousOnPhase[k] = lastOnPhase[phase];
+            lastOnPhase[phase] = k;
+            index += 2;
+        }
+    }
+    
+    // Branch impedances, zero impedances are replaced by a tiny one
+    returnImpedances.assign(length, 0.0L);
+    feederImpedances.assign(length, 0.0L);
+    powers.assign(length, 0.0L);
+    for (size_t k = 0; k < length; k++) {
+        Resistor *segment = dynamic_cast<Resistor *>(_circuit[k]);
+        Resistor *feeder = dynamic_cast<Resistor *>(_circuit[consumerOf[k]+1]);
+        Consumer *consumer = dynamic_cast<Consumer *>(_circuit[consumerOf[k]]);
+        if (!segment || !feeder || !consumer)
+            return false;
         
-        for (int i = 0; i < _circuit.size(); i++) {
-            cout << setw(19) << _circuit[i]->elementName();
-            cout << "         _____" << endl;
-            cout << setw(19) << _circuit[i]->getPortParameter(PORT_L, VOLTAGE) << " V";
-            cout << "   ___|     |___";
-            cout << setw(19) << _circuit[i]->getPortParameter(PORT_R, VOLTAGE) << " V" << endl;
-            cout << setw(19) << _circuit[i]->getPortParameter(PORT_L, CURRENT) << " A";
-            cout << "      |_____|   ";
-            cout << setw(19) << _circuit[i]->getPortParameter(PORT_R, CURRENT) << " A" << endl << endl;
+        returnImpedances[k] = complexLong(segment->getImpedance().real(), segment->getImpedance().imag());
+        feederImpedances[k] = complexLong(feeder->getImpedance().real(), feeder->getImpedance().imag());
+        if (abs(returnImpedances[k]) == 0)
+            returnImpedances[k] = 1e-12L;
+        if (abs(feederImpedances[k]) == 0)
+            feederImpedances[k] = 1e-12L;
+        // Exporting consumers keep the sign of their real power
+        powers[k] = (consumer->getPower().real() < 0.0 ? -1.0L : 1.0L) * abs(consumer->getPower());
+    }
+    
+    return true;
+}
+
+void Simulation::solveReference() {
+    typedef complex<long double> complexLong;
+    
+    vector<size_t> consumerOf;
+    vector<long> previousOnPhase;
+    vector<complexLong> returnImpedances, feederImpedances;
+    vector<long double> powers;
+    if (!collectBranches(consumerOf, previousOnPhase, returnImpedances, feederImpedances, powers)) {
+        cout << "ERROR : Reference solver requires an assembled circuit." << endl;
+        return;
+    }
+    size_t length = powers.size();
+    
+    // Half bandwidth of the nodal matrix
+    size_t band = 2;
+    for (size_t k = 0; k < length; k++)
+        if (previousOnPhase[k] >= 0)
+            band = max(band, (size_t)(2*k+1 - (2*previousOnPhase[k]+1)));
+    
+    size_t nodes = 2 * length;
+    size_t width = 2 * band + 1;
+    complexLong sink(_vss.real(), _vss.imag());
+    
+    // Consumers draw their apparent power as a resistance of |V|^2/|S|, which
+    // is negative for an exporting consumer. The iteration starts from the
+    // previous solution of this circuit if there is one, else from the
+    // nominal voltage
+    vector<long double> loads(length);
+    vector<complexLong> voltages(nodes, 0.0L);
+    bool warmStart = (_referenceVoltages.size() == nodes);
+    if (warmStart)
+        voltages = _referenceVoltages;
+    for (size_t k = 0; k < length; k++) {
+        complex<double> nominal = phaseSource(_connectionOrder[k]) - _vss;
+        long double magnitude = warmStart ? norm(voltages[2*k+1] - voltages[2*k]) : norm(complexLong(nominal.real(), nominal.imag()));
+        loads[k] = (powers[k] != 0) ? magnitude / powers[k] : INFINITY;
+    }
+    _converged = false;
+    long double previousChange = INFINITY;
+    int growing = 0;
+    
+    for (int iteration = 0; iteration < REFERENCE_ITERATIONS; iteration++) {
+        // Banded nodal matrix, element (i, j) is stored at i*width + j-i+band
+        vector<complexLong> matrix(nodes * width, 0.0L);
+        vector<complexLong> currents(nodes, 0.0L);
+        
+        for (size_t k = 0; k < length; k++) {
+            size_t returnNode = 2*k;
+            size_t feederNode = 2*k + 1;
+            
+            // Return line segment towards the substation
+            complexLong admittance = 1.0L / returnImpedances[k];
+            matrix[returnNode*width + band] += admittance;
+            if (k > 0) {
+                matrix[(returnNode-2)*width + band] += admittance;
+                matrix[returnNode*width + band-2] -= admittance;
+                matrix[(returnNode-2)*width + band+2] -= admittance;
+            } else {
+                currents[returnNode] += admittance * sink;
+            }
+            
+            // Feeder segment towards the source
+            admittance = 1.0L / feederImpedances[k];
+            matrix[feederNode*width + band] += admittance;
+            if (previousOnPhase[k] >= 0) {
+                size_t previous = 2*previousOnPhase[k] + 1;
+                size_t distance = feederNode - previous;
+                matrix[previous*width + band] += admittance;
+                matrix[feederNode*width + band-distance] -= admittance;
+                matrix[previous*width + band+distance] -= admittance;
+            } else {
+                complex<double> source = phaseSource(_connectionOrder[k]);
+                currents[feederNode] += admittance * complexLong(source.real(), source.imag());
+            }
+            
+            // Consumer between both
+            if (loads[k] != INFINITY) {
+                admittance = 1.0L / loads[k];
+                matrix[feederNode*width + band] += admittance;
+                matrix[returnNode*width + band] += admittance;
+                matrix[feederNode*width + band-1] -= admittance;
+                matrix[returnNode*width + band+1] -= admittance;
+            }
+        }
+        
+        // Gaussian elimination within the band. The matrix is diagonally
+        // dominant, so no pivoting is needed
+        for (size_t i = 0; i < nodes; i++) {
+            complexLong pivot = matrix[i*width + band];
+            for (size_t j = i+1; j <= min(nodes-1, i+band); j++) {
+                complexLong factor = matrix[j*width + i-j+band] / pivot;
+                if (factor == 0.0L)
+                    continue;
+                for (size_t c = i; c <= min(nodes-1, i+band); c++)
+                    matrix[j*width + c-j+band] -= factor * matrix[i*width + c-i+band];
+                currents[j] -= factor * currents[i];
+            }
+        }
+        
+        vector<complexLong> solution(nodes);
+        for (size_t i = nodes; i-- > 0;) {
+            complexLong sum = currents[i];
+            for (size_t c = i+1; c <= min(nodes-1, i+band); c++)
+                sum -= matrix[i*width + c-i+band] * solution[c];
+            solution[i] = sum / matrix[i*width + band];
+        }
+        
+        // A NaN anywhere must not be hidden by max
+        long double change = 0.0L;
+        for (size_t i = 0; i < nodes; i++) {
+            long double difference = abs(solution[i] - voltages[i]);
+            if (difference != difference || difference > change)
+                change = difference;
+        }
+        voltages = solution;
+        
+        // Update the loads for the new voltages
+        for (size_t k = 0; k < length; k++)
+            if (powers[k] != 0)
+                loads[k] = norm(voltages[2*k+1] - voltages[2*k]) / powers[k];
+        
+        if (change < REFERENCE_TOLERANCE) {
+            // Constant power loads also converge to a collapsed feeder,
+            // which is not a solution
+            _converged = true;
+            for (size_t k = 0; k < length; k++) {
+                complex<double> nominal = phaseSource(_connectionOrder[k]) - _vss;
+                if (powers[k] != 0 && abs(voltages[2*k+1] - voltages[2*k]) < REFERENCE_COLLAPSE * abs(nominal))
+                    _converged = false;
+            }
+            if (!_converged && !_silent)
+                cout << "ERROR : Reference solver converged to a collapsed feeder." << endl;
+            break;
+        }
+        
+        // With a ceiling, a consumer further above it than the iteration
+        // still moves will not come back below, and growing changes only
+        // lead to collapse
+        if (_voltageCeiling > 0.0) {
+            growing = (change > previousChange) ? growing + 1 : 0;
+            previousChange = change;
+            long double highest = 0.0L;
+            for (size_t k = 0; k < length; k++)
+                highest = max(highest, abs(voltages[2*k+1] - voltages[2*k]));
+            if (highest - _voltageCeiling > change || growing >= REFERENCE_DIVERGENCE)
+                break;
+        }
+        
+        // Loads beyond the point of voltage collapse have no solution
+        if (change != change || iteration == REFERENCE_ITERATIONS-1) {
+            if (!_silent)
+                cout << "ERROR : Reference solver did not converge." << endl;
+            break;
+        }
+    }
+    
+    // Only a converged solution is a good start for the next solve
+    if (_converged)
+        _referenceVoltages = voltages;
+    else
+        _referenceVoltages.clear();
+    
+    storeNodeVoltages(voltages, loads, consumerOf, previousOnPhase, returnImpedances, feederImpedances);
+}
+
+void Simulation::solveLinear() {
+    typedef complex<long double> complexLong;
+    
+    vector<size_t> consumerOf;
+    vector<long> previousOnPhase;
+    vector<complexLong> returnImpedances, feederImpedances;
+    vector<long double> powers;
+    if (!collectBranches(consumerOf, previousOnPhase, returnImpedances, feederImpedances, powers)) {
+        cout << "ERROR : Linear solver requires an assembled circuit." << endl;
+        return;
+    }
+    size_t length = powers.size();
+    complexLong sink(_vss.real(), _vss.imag());
+    
+    // Like LinDistFlow, every consumer draws its power at the nominal voltage
+    // and the losses of the segments are neglected, so the currents are
+    // known up front. Summing them from the end of the feeder gives the
+    // current of every segment
+    vector<complexLong> returnCurrents(length, 0.0L);
+    vector<complexLong> feederCurrents(length, 0.0L);
+    for (size_t k = length; k-- > 0;) {
+        complex<double> nominal = phaseSource(_connectionOrder[k]) - _vss;
+        complexLong current = powers[k] / conj(complexLong(nominal.real(), nominal.imag()));
+        
+        returnCurrents[k] = current + (k+1 < length ? returnCurrents[k+1] : 0.0L);
+        feederCurrents[k] += current;
+        if (previousOnPhase[k] >= 0)
+            feederCurrents[previousOnPhase[k]] += feederCurrents[k];
+    }
+    
+    // Then the drops add up from the substation in a single pass
+    vector<complexLong> voltages(2 * length);
+    vector<long double> loads(length);
+    for (size_t k = 0; k < length; k++) {
+        voltages[2*k] = (k > 0 ? voltages[2*k-2] : sink) + returnCurrents[k] * returnImpedances[k];
+        
+        complexLong upstream;
+        if (previousOnPhase[k] >= 0) {
+            upstream = voltages[2*previousOnPhase[k]+1];
+        } else {
+            complex<double> source = phaseSource(_connectionOrder[k]);
+            upstream = complexLong(source.real(), source.imag());
+        }
+        voltages[2*k+1] = upstream - feederCurrents[k] * feederImpedances[k];
+    }
+    
+    // Consumer resistances at those voltages
+    for (size_t k = 0; k < length; k++)
+        loads[k] = (powers[k] != 0) ? norm(voltages[2*k+1] - voltages[2*k]) / powers[k] : INFINITY;
+    
+    _converged = true;
+    storeNodeVoltages(voltages, loads, consumerOf, previousOnPhase, returnImpedances, feederImpedances);
+}
+
+void Simulation::screenLinear() {
+    _screening.scenarios++;
+    
+    size_t length = _returnImpedances.size();
+    vector<double> linear;
+    bool closeToLimit = false;
+    for (size_t i = length; i < _circuit.size(); i += 2) {
+        double voltage = abs(_circuit[i]->getPortParameter(PORT_L, VOLTAGE) - _circuit[i]->getPortParameter(PORT_R, VOLTAGE));
+        double nominal = abs(phaseSource(_elementPhases[i]) - _vss);
+        if (voltage < (SCREENING_LOWER + SCREENING_MARGIN) * nominal
+            || voltage > (SCREENING_UPPER - SCREENING_MARGIN) * nominal)
+            closeToLimit = true;
+        linear.push_back(voltage);
+    }
+    
+    if (!closeToLimit && _screening.scenarios % SCREENING_CHECK != 0)
+        return;
+    
+    // The full solution replaces the linear one
+    solveReference();
+    
+    double error = 0.0;
+    for (size_t i = length; i < _circuit.size(); i += 2) {
+        double voltage = abs(_circuit[i]->getPortParameter(PORT_L, VOLTAGE) - _circuit[i]->getPortParameter(PORT_R, VOLTAGE));
+        error = max(error, fabs(voltage - linear[(i - length) / 2]));
+    }
+    
+    if (closeToLimit)
+        _screening.resolved++;
+    _screening.checked++;
+    _screening.maxError = max(_screening.maxError, error);
+    _screening.errorSum += error;
+}
+
+void Simulation::storeNodeVoltages(vector< complex<long double> > &voltages, vector<long double> &loads, vector<size_t> &consumerOf, vector<long> &previousOnPhase, vector< complex<long double> > &returnImpedances, vector< complex<long double> > &feederImpedances) {
+    typedef complex<long double> complexLong;
+    
+    size_t length = loads.size();
+    complexLong sink(_vss.real(), _vss.imag());
+    
+    for (size_t k = 0; k < length; k++) {
+        Resistor *segment = dynamic_cast<Resistor *>(_circuit[k]);
+        Consumer *consumer = dynamic_cast<Consumer *>(_circuit[consumerOf[k]]);
+        Resistor *feeder = dynamic_cast<Resistor *>(_circuit[consumerOf[k]+1]);
+        
+        complexLong returnNode = voltages[2*k];
+        complexLong feederNode = voltages[2*k+1];
+        complexLong substation = (k > 0) ? voltages[2*k-2] : sink;
+        complexLong upstream;
+        if (previousOnPhase[k] >= 0) {
+            upstream = voltages[2*previousOnPhase[k]+1];
+        } else {
+            complex<double> source = phaseSource(_connectionOrder[k]);
+            upstream = complexLong(source.real(), source.imag());
         }
+        
+        complexLong current = (returnNode - substation) / returnImpedances[k];
+        segment->setPortParameter(PORT_L, VOLTAGE, complex<double>(returnNode));
+        segment->setPortParameter(PORT_R, VOLTAGE, complex<double>(substation));
+        segment->setPortParameter(PORT_L, CURRENT, complex<double>(current));
+        segment->setPortParameter(PORT_R, CURRENT, -complex<double>(current));
+        
+        current = (upstream - feederNode) / feederImpedances[k];
+        feeder->setPortParameter(PORT_L, VOLTAGE, complex<double>(upstream));
+        feeder->setPortParameter(PORT_R, VOLTAGE, complex<double>(feederNode));
+        feeder->setPortParameter(PORT_L, CURRENT, complex<double>(current));
+        feeder->setPortParameter(PORT_R, CURRENT, -complex<double>(current));
+        
+        current = (loads[k] != INFINITY) ? (feederNode - returnNode) / loads[k] : 0.0L;
+        consumer->setImpedance((double) loads[k]);
+        consumer->setPortParameter(PORT_L, VOLTAGE, complex<double>(feederNode));
+        consumer->setPortParameter(PORT_R, VOLTAGE, complex<double>(returnNode));
+        consumer->setPortParameter(PORT_L, CURRENT, complex<double>(current));
+        consumer->setPortParameter(PORT_R, CURRENT, -complex<double>(current));
+    }
+}
+
+complex<double> Simulation::phaseSource(int phase) {
+    double angle = (double)(2 * M_PI / _phases);
+    double offset = (double)tan(_vcc.imag() / _vcc.real());
+    if (offset == 0.0 && _vcc.real() < 0)
+        offset = M_PI;
+    
+    double real = abs(_vcc) * cos(angle * (phase-1) + offset);
+    double imag = abs(_vcc) * sin(angle * (phase-1) + offset);
+    
+    return complex<double> (real, imag);
+}
+
+bool Simulation::hasConverged() {
+    return _converged;
+}
+
+screeningStatistics Simulation::getScreening() {
+    return _screening;
+}
+
+bool Simulation::updatePowers() {
+    // Nothing to update if no circuit has been assembled
+    if (_circuit.empty())
+        return false;
+    
+    // Consumers are connected in the order given by the connection order and
+    // sit right after the return line, each followed by its feeder segment
+    size_t returnLineLength = _returnImpedances.size();
+    if (_connectionOrder.size() != returnLineLength
+        || _circuit.size() != returnLineLength * 3)
+        return false;
+    
+    // The powers must still fit the wiring exactly, any other order or
+    // number of houses per phase needs a new circuit
+    if (_connectionOrder != _assembledOrder || _assembledCounts.size() != _phases || _powers.size() != _phases)
+        return false;
+    for (int phase = 0; phase < _phases; phase++)
+        if (_powers[phase].size() != _assembledCounts[phase])
+            return false;
+    
+    vector<int> connectionsPerPhase(_phases, 0);
+    for (size_t i = returnLineLength; i < _circuit.size(); i += 2) {
+        Consumer *consumer = dynamic_cast<Consumer *>(_circuit[i]);
+        int phase = _elementPhases[i];
+        
+        if (!consumer || phase < 1 || phase > _phases
+            || connectionsPerPhase[phase-1] >= _powers[phase-1].size())
+            return false;
+        
+        consumer->setPower(_powers[phase-1][connectionsPerPhase[phase-1]]);
+        connectionsPerPhase[phase-1]++;
     }
+    
+    return true;
 }
 
 void Simulation::saveFeeders(string path, bool saveComplex) {
 #pragma mark SAVING FEEDER
     if (_verbose) cout << endl << SPACER << endl;
-    cout << "SAVING FEEDER" << endl << endl;
+    if (!_silent) cout << "SAVING FEEDER" << endl << endl;
 
     // Check if the circuit exists and halt if not
     if (_circuit.empty()) {
@@ -395,161 +1002,35 @@ void Simulation::saveFeeders(string path, bool saveComplex) {
     pathStream << path << ".csv";
     path = pathStream.str();
     
-    // Generate output stream
-    ofstream output(path.c_str(), ios::binary);
-    if (output.is_open()) {
-        
-        vector<Element *> storageElements;
+    vector<Resistor *> elements;
+    vector<Element *> storageElements;
+    
+    // Analysie each element in the circuit and only write the port values
+    // of consumers and storage devices so that they may be interpreted
+    for (int i = 0; i < _circuit.size(); i++) {
         
-        if (saveComplex) {
-            // If complex values are to be stored. That includes real and
-            // imaginary
+        // Check if the element at hand is a consumer thus is located
+        // along the feeder invetween phase and return
+        if (Consumer *consumer = dynamic_cast<Consumer *>(_circuit[i])) {
             
-            // Mate title row
-            output << "Name,Re(V_l),Im(V_l),Re(V_r),Im(V_r),Re(I),Im(I),Re(Z),Im(Z),Re(S),Im(S)" << endl;
-        
-            // Analysie each element in the circuit and only write the port values
-            // of consumers and storage devices so that they may be interpreted
-            for (int i = 0; i < _circuit.size(); i++) {
-                
-                // Check if the element at hand is a consumer thus is located
-                // along the feeder invetween phase and return
-                if (Consumer *consumer = dynamic_cast<Consumer *>(_circuit[i])) {
-                    
-                    // Then check if one deals with storage since this information
-                    // will be stored in a separate row
-                    if (Storage *storage = dynamic_cast<Storage *>(consumer)) {
-                        // Save storage for later
-                        storageElements.push_back(storage);
-                    } else {
-                        // Write data to file
-                        
-                        // Outputting element name
-                        output << consumer->elementName() << ",";
-                        
-                        // Getting voltage
-                        complex<double> voltageL = consumer->getPortParameter(PORT_L, VOLTAGE);
-                        complex<double> voltageR = consumer->getPortParameter(PORT_R, VOLTAGE);
-                        
-                        // Outputting voltage
-                        output << voltageL.real() << ",";
-                        output << voltageL.imag() << ",";
-                        output << voltageR.real() << ",";
-                        output << voltageR.imag() << ",";
-                        
-                        // Getting current
-                        complex<double> current = consumer->getPortParameter(PORT_L, CURRENT);
-                        
-                        // Outputting current
-                        output << current.real() << ",";
-                        output << current.imag() << ",";
-                        
-                        // Computing impedance
-                        complex<double> impedance;
-                        if (abs(current) == 0)
-                            impedance = INFINITY;
-                        else
-                            impedance = (voltageL-voltageR) / current;
-                        
-                        // Outputting impedance
-                        output << impedance.real() << ",";
-                        output << impedance.imag() << ",";
-                        
-                        // Computing power
-                        complex<double> power;
-                        if (abs(current) == 0)
-                            power = 0;
-                        else
-                            power = (voltageL-voltageR) * current;
-                        
-                        // Outputting power
-                        output << power.real() << ",";
-                        output << power.imag() << endl;
-                    }
-                }
-            }
-        } else {
-            // If not complex, only absolute values are needed
-            
-            // Mate title row
-            output << "Name,V_l,V_r,I,Z,S" << endl;
-            
-            // Analysie each element in the circuit and only write the port values
-            // of consumers and storage devices so that they may be interpreted
-            for (int i = 0; i < _circuit.size(); i++) {
-                
-                // Check if the element at hand is a consumer thus is located
-                // along the feeder invetween phase and return
-                if (Consumer *consumer = dynamic_cast<Consumer *>(_circuit[i])) {
-                    
-                    // Then check if one deals with storage since this information
-                    // will be stored in a separate row
-                    if (Storage *storage = dynamic_cast<Storage *>(consumer)) {
-                        // Save storage for later
-                        storageElements.push_back(storage);
-                    } else {
-                        // Write data to file
-                        
-                        // Outputting element name
-                        output << consumer->elementName() << ",";
-                        
-                        // Getting voltage
-                        double voltageL = abs(consumer->getPortParameter(PORT_L, VOLTAGE));
-                        double voltageR = abs(consumer->getPortParameter(PORT_R, VOLTAGE));
-                        
-                        // Outputting voltage
-                        output << voltageL << ",";
-                        output << voltageR << ",";
-                        
-                        // Getting current
-                        double current = abs(consumer->getPortParameter(PORT_L, CURRENT));
-                        
-                        // Outputting current
-                        output << current << ",";
-                        
-                        // Computing impedance
-                        double impedance;
-                        if (current == 0)
-                            impedance = INFINITY;
-                        else
-                            impedance = (voltageL-voltageR) / current;
-                        
-                        // Outputting impedance
-                        output << impedance << ",";
-                        
-                        // Computing power
-                        double power;
-                        if (current == 0)
-                            power = 0;
-                        else
-                            power = (voltageL-voltageR) * current;
-                        
-                        // Outputting power
-                        output << power << endl;
-                    }
-                }
+            // Then check if one deals with storage since this information
+            // will be stored in a separate row
+            if (Storage *storage = dynamic_cast<Storage *>(consumer)) {
+                // Save storage for later
+                storageElements.push_back(storage);
+            } else {
+                elements.push_back(consumer);
             }
         }
-        
-        
-        // Close the output stream before returning
-        output.close();
-        if (_verbose) {
-            cout << " File successfully written to:" << endl;
-            cout << path << endl;
-        }
-    } else {
-        cout << "ERROR : Could not generate <" << path << ">." << endl;
-        return;
     }
     
-    return;
+    saveElements(path, elements, saveComplex);
 }
 
 void Simulation::saveSubstation(string path, bool saveComplex) {
 #pragma mark SAVING SUBSTATION
     if (_verbose) cout << endl << SPACER << endl;
-    cout << "SAVING SUBSTATION" << endl << endl;
+    if (!_silent) cout << "SAVING SUBSTATION" << endl << endl;
     
     // Check if the circuit exists and halt if not
     if (_circuit.empty()) {
@@ -562,149 +1043,349 @@ void Simulation::saveSubstation(string path, bool saveComplex) {
     pathStream << path << "s.csv";
     path = pathStream.str();
     
+    vector<Resistor *> elements;
+    
+    // Only extract the lines connected to sources. These are exactly the
+    // entry elements, which were added in circuit order during assembly
+    for (int i = 0; i < _entryElements.size(); i++) {
+        if (Resistor *resistor = dynamic_cast<Resistor *>(_entryElements[i]))
+            elements.push_back(resistor);
+    }
+    
+    saveElements(path, elements, saveComplex);
+}
+
+void Simulation::saveResults(ResultStore *store, int sample) {
+    MetricsTimer timer(_metrics, SaveTimer);
+    TraceSpan span("write results");
+    MemoryStageScope stage(WriteStage);
+    
+    // Check if the circuit exists and halt if not
+    if (_circuit.empty()) {
+        cout << "ERROR : No circuit has been set up." << endl;
+        return;
+    }
+    
+    // Describe all elements when writing the first sample
+    if (!store->isOpen()) {
+        vector<string> names;
+        for (int i = 0; i < _circuit.size(); i++)
+            names.push_back(_circuit[i]->elementName());
+        
+        if (!store->open(names, _elementPhases, sample))
+            return;
+    }
+    
+    // Collect the values of each element in the order of the store
+    vector<double> values(_circuit.size() * NumberOfQuantities);
+    for (int i = 0; i < _circuit.size(); i++) {
+        complex<double> voltageL = _circuit[i]->getPortParameter(PORT_L, VOLTAGE);
+        complex<double> voltageR = _circuit[i]->getPortParameter(PORT_R, VOLTAGE);
+        complex<double> current = _circuit[i]->getPortParameter(PORT_L, CURRENT);
+        
+        // Same definition of power as in the CSV output
+        complex<double> power;
+        if (abs(current) == 0)
+            power = 0;
+        else
+            power = (voltageL-voltageR) * current;
+        
+        double *value = &values[i * NumberOfQuantities];
+        value[VoltageLeftReal] = voltageL.real();
+        value[VoltageLeftImag] = voltageL.imag();
+        value[VoltageRightReal] = voltageR.real();
+        value[VoltageRightImag] = voltageR.imag();
+        value[CurrentReal] = current.real();
+        value[CurrentImag] = current.imag();
+        value[PowerReal] = power.real();
+        value[PowerImag] = power.imag();
+    }
+    
+    store->appendSample(values);
+}
+
+void Simulation::summariseResults(Summary *summary) {
+    TraceSpan span("summarise");
+    
+    // Check if the circuit exists and halt if not
+    if (_circuit.empty()) {
+        cout << "ERROR : No circuit has been set up." << endl;
+        return;
+    }
+    
+    // Describe all elements for the first sample. Consumers are the houses,
+    // every other resistor is a segment of a feeder or the return line
+    if (!summary->isSetUp()) {
+        vector<string> names;
+        vector<int> kinds;
+        for (int i = 0; i < _circuit.size(); i++) {
+            names.push_back(_circuit[i]->elementName());
+            kinds.push_back(dynamic_cast<Consumer *>(_circuit[i])
+                            ? SummaryHouse : SummaryLine);
+        }
+        
+        summary->setup(names, kinds, _elementPhases, _phases, abs(_vcc - _vss));
+    }
+    
+    vector<double> voltages(_circuit.size());
+    vector<double> currents(_circuit.size());
+    vector<double> losses(_circuit.size());
+    
+    for (int i = 0; i < _circuit.size(); i++) {
+        Resistor *resistor = dynamic_cast<Resistor *>(_circuit[i]);
+        if (!resistor)
+            continue;
+        
+        complex<double> current = resistor->getCurrent();
+        voltages[i] = abs(resistor->getLeftVoltage() - resistor->getRightVoltage());
+        currents[i] = abs(current);
+        
+        // Only line segments cause losses, I^2 * R
+        if (!dynamic_cast<Consumer *>(resistor))
+            losses[i] = norm(current) * resistor->getImpedance().real();
+    }
+    
+    summary->addSample(voltages, currents, losses);
+}
+
+void Simulation::getElementStates(vector< complex<double> > &leftVoltages, vector< complex<double> > &rightVoltages, vector< complex<double> > &currents, vector< complex<double> > &impedances) {
+    leftVoltages.clear();
+    rightVoltages.clear();
+    currents.clear();
+    impedances.clear();
+    
+    for (int i = 0; i < _circuit.size(); i++) {
+        Resistor *resistor = dynamic_cast<Resistor *>(_circuit[i]);
+        if (!resistor)
+            continue;
+        
+        leftVoltages.push_back(resistor->getLeftVoltage());
+        rightVoltages.push_back(resistor->getRightVoltage());
+        currents.push_back(resistor->getCurrent());
+        impedances.push_back(resistor->getImpedance());
+    }
+}
+
+void Simulation::getConnectionVoltages(vector<double> &voltages) {
+    voltages.assign(_connectionOrder.size(), 0.0);
+    
+    // Consumers are grouped by phase, in connection order within each
+    size_t returnLineLength = _returnImpedances.size();
+    if (_circuit.size() != returnLineLength * 3)
+        return;
+    
+    size_t element = returnLineLength;
+    for (int phase = 1; phase <= _phases; phase++) {
+        for (size_t k = 0; k < _connectionOrder.size(); k++) {
+            if (_connectionOrder[k] != phase)
+                continue;
+            Resistor *consumer = dynamic_cast<Resistor *>(_circuit[element]);
+            if (consumer)
+                voltages[k] = abs(consumer->getLeftVoltage() - consumer->getRightVoltage());
+            element += 2;
+        }
+    }
+}
+
+bool Simulation::writeScenario(FILE *file) {
+    int32_t phases = _phases;
+    double voltages[4] = {_vcc.real(), _vcc.imag(), _vss.real(), _vss.imag()};
+    fwrite(&phases, sizeof(int32_t), 1, file);
+    fwrite(voltages, sizeof(double), 4, file);
+    
+    for (int i = 0; i < _phases; i++)
+        writeValues(file, _feederImpedances[i]);
+    writeValues(file, _returnImpedances);
+    for (int i = 0; i < _phases; i++)
+        writeValues(file, _powers[i]);
+    
+    uint64_t connections = _connectionOrder.size();
+    fwrite(&connections, sizeof(uint64_t), 1, file);
+    for (size_t i = 0; i < _connectionOrder.size(); i++) {
+        int32_t phase = _connectionOrder[i];
+        fwrite(&phase, sizeof(int32_t), 1, file);
+    }
+    
+    return !ferror(file);
+}
+
+bool Simulation::readScenario(FILE *file, bool &feederChanged) {
+    int32_t phases = 0;
+    double voltages[4];
+    if (fread(&phases, sizeof(int32_t), 1, file) != 1
+        || fread(voltages, sizeof(double), 4, file) != 4
+        || phases < _minPhases || phases > _maxPhases)
+        return false;
+    
+    vector< vector< complex<double> > > feederImpedances(phases);
+    vector< complex<double> > returnImpedances;
+    vector< vector< complex<double> > > powers(phases);
+    
+    for (int i = 0; i < phases; i++)
+        if (!readValues(file, feederImpedances[i]))
+            return false;
+    if (!readValues(file, returnImpedances))
+        return false;
+    for (int i = 0; i < phases; i++)
+        if (!readValues(file, powers[i]))
+            return false;
+    
+    uint64_t connections = 0;
+    if (fread(&connections, sizeof(uint64_t), 1, file) != 1 || connections != returnImpedances.size())
+        return false;
+    vector<int32_t> connectionOrder(connections);
+    if (connections && fread(&connectionOrder[0], sizeof(int32_t), connections, file) != connections)
+        return false;
+    
+    complex<double> vcc(voltages[0], voltages[1]);
+    complex<double> vss(voltages[2], voltages[3]);
+    
+    // Only a different feeder, or the same one wired in a different order,
+    // requires a new circuit
+    vector<int> order(connectionOrder.begin(), connectionOrder.end());
+    feederChanged = (phases != _phases || vcc != _vcc || vss != _vss
+                     || feederImpedances != _feederImpedances
+                     || returnImpedances != _returnImpedances
+                     || order != _connectionOrder);
+    if (feederChanged) {
+        setPhases(phases);
+        setSource(vcc);
+        setSink(vss);
+        _feederImpedances = feederImpedances;
+        _returnImpedances = returnImpedances;
+    }
+    
+    _powers = powers;
+    _connectionOrder = order;
+    
+    return true;
+}
+
+#pragma mark PROTECTED
+
+void Simulation::saveElements(string path, vector<Resistor *> elements, bool saveComplex) {
+    MetricsTimer timer(_metrics, SaveTimer);
+    TraceSpan span("write csv");
+    MemoryStageScope stage(WriteStage);
+    
     // Generate output stream
-    ofstream output(path.c_str(), ios::binary);
-    if (output.is_open()) {
+    CSVWriter output(path);
+    if (!output.isOpen()) {
+        cout << "ERROR : Could not generate <" << path << ">." << endl;
+        return;
+    }
+    
+    // Collect all names and values first so they can be formatted in one go
+    size_t columns = saveComplex ? 10 : 5;
+    vector<string> names(elements.size());
+    vector<double> values(elements.size() * columns);
+    
+    for (size_t i = 0; i < elements.size(); i++) {
+        names[i] = elements[i]->elementName();
+        double *value = &values[i * columns];
         
-        vector<Element *> storageElements;
+        complex<double> voltageL = elements[i]->getLeftVoltage();
+        complex<double> voltageR = elements[i]->getRightVoltage();
+        complex<double> current = elements[i]->getCurrent();
         
         if (saveComplex) {
             // If complex values are to be stored. That includes real and
             // imaginary
             
-            // Mate title row
-            output << "Name,Re(V_l),Im(V_l),Re(V_r),Im(V_r),Re(I),Im(I),Re(Z),Im(Z),Re(S),Im(S)" << endl;
+            // Computing impedance
+            complex<double> impedance;
+            if (abs(current) == 0)
+                impedance = INFINITY;
+            else
+                impedance = (voltageL-voltageR) / current;
             
-            // Analysie each element in the circuit and only write the port values
-            // of consumers and storage devices so that they may be interpreted
-            for (int i = 0; i < _circuit.size(); i++) {
-                
-                // Check if the element at hand is a consumer thus is located
-                // along the feeder invetween phase and return
-                if (Resistor *resistor = dynamic_cast<Resistor *>(_circuit[i])) {
-                    // Write data to file
-                    
-                    // Only extract the lines connected to sources
-                    if (!resistor->isPortParameterFixed(PORT_L, VOLTAGE) &&
-                        !resistor->isPortParameterFixed(PORT_R, VOLTAGE)) {
-                        continue;
-                    }
-                    
-                    // Outputting element name
-                    output << resistor->elementName() << ",";
-                    
-                    // Getting voltage
-                    complex<double> voltageL = resistor->getPortParameter(PORT_L, VOLTAGE);
-                    complex<double> voltageR = resistor->getPortParameter(PORT_R, VOLTAGE);
-                    
-                    // Outputting voltage
-                    output << voltageL.real() << ",";
-                    output << voltageL.imag() << ",";
-                    output << voltageR.real() << ",";
-                    output << voltageR.imag() << ",";
-                    
-                    // Getting current
-                    complex<double> current = resistor->getPortParameter(PORT_L, CURRENT);
-                    
-                    // Outputting current
-                    output << current.real() << ",";
-                    output << current.imag() << ",";
-                    
-                    // Computing impedance
-                    complex<double> impedance;
-                    if (abs(current) == 0)
-                        impedance = INFINITY;
-                    else
-                        impedance = (voltageL-voltageR) / current;
-                    
-                    // Outputting impedance
-                    output << impedance.real() << ",";
-                    output << impedance.imag() << ",";
-                    
-                    // Computing power
-                    complex<double> power;
-                    if (abs(current) == 0)
-                        power = 0;
-                    else
-                        power = (voltageL-voltageR) * current;
-                    
-                    // Outputting power
-                    output << power.real() << ",";
-                    output << power.imag() << endl;
-                }
-            }
+            // Computing power
+            complex<double> power;
+            if (abs(current) == 0)
+                power = 0;
+            else
+                power = (voltageL-voltageR) * current;
+            
+            value[0] = voltageL.real();
+            value[1] = voltageL.imag();
+            value[2] = voltageR.real();
+            value[3] = voltageR.imag();
+            value[4] = current.real();
+            value[5] = current.imag();
+            value[6] = impedance.real();
+            value[7] = impedance.imag();
+            value[8] = power.real();
+            value[9] = power.imag();
         } else {
             // If not complex, only absolute values are needed
+            double absVoltageL = abs(voltageL);
+            double absVoltageR = abs(voltageR);
+            double absCurrent = abs(current);
             
-            // Mate title row
-            output << "Name,V_l,V_r,I,Z,S" << endl;
-            
-            // Analysie each element in the circuit and only write the port values
-            // of consumers and storage devices so that they may be interpreted
-            for (int i = 0; i < _circuit.size(); i++) {
-                
-                // Check if the element at hand is a consumer thus is located
-                // along the feeder invetween phase and return
-                if (Resistor *resistor = dynamic_cast<Resistor *>(_circuit[i])) {
-                    // Write data to file
-                    
-                    // Only extract the lines connected to sources
-                    if (!resistor->isPortParameterFixed(PORT_L, VOLTAGE) &&
-                        !resistor->isPortParameterFixed(PORT_R, VOLTAGE)) {
-                        continue;
-                    }
-                    
-                    // Outputting element name
-                    output << resistor->elementName() << ",";
-                    
-                    // Getting voltage
-                    double voltageL = abs(resistor->getPortParameter(PORT_L, VOLTAGE));
-                    double voltageR = abs(resistor->getPortParameter(PORT_R, VOLTAGE));
-                    
-                    // Outputting voltage
-                    output << voltageL << ",";
-                    output << voltageR << ",";
-                    
-                    // Getting current
-                    double current = abs(resistor->getPortParameter(PORT_L, CURRENT));
-                    
-                    // Outputting current
-                    output << current << ",";
-                    
-                    // Computing impedance
-                    double impedance;
-                    if (current == 0)
-                        impedance = INFINITY;
-                    else
-                        impedance = (voltageL-voltageR) / current;
-                    
-                    // Outputting impedance
-                    output << impedance << ",";
-                    
-                    // Computing power
-                    double power;
-                    if (current == 0)
-                        power = 0;
-                    else
-                        power = (voltageL-voltageR) * current;
-                    
-                    // Outputting power
-                    output << power << endl;
-                }
-            }
+            value[0] = absVoltageL;
+            value[1] = absVoltageR;
+            value[2] = absCurrent;
+            value[3] = (absCurrent == 0) ? INFINITY : (absVoltageL-absVoltageR) / absCurrent;
+            value[4] = (absCurrent == 0) ? 0 : (absVoltageL-absVoltageR) * absCurrent;
         }
+    }
+    
+    // Mate title row
+    if (saveComplex)
+        output.write("Name,Re(V_l),Im(V_l),Re(V_r),Im(V_r),Re(I),Im(I),Re(Z),Im(Z),Re(S),Im(S)\n");
+    else
+        output.write("Name,V_l,V_r,I,Z,S\n");
+    
+    output.writeRows(names, values, columns);
+    
+    // Close the output stream before returning
+    output.close();
+    if (_verbose) {
+        cout << " File successfully written to:" << endl;
+        cout << path << endl;
+    }
+}
+
+void Simulation::writeValues(FILE *file, vector< complex<double> > &values) {
+    uint64_t count = values.size();
+    fwrite(&count, sizeof(uint64_t), 1, file);
+    if (count)
+        fwrite(&values[0], sizeof(complex<double>), count, file);
+}
+
+bool Simulation::readValues(FILE *file, vector< complex<double> > &values) {
+    uint64_t count = 0;
+    if (fread(&count, sizeof(uint64_t), 1, file) != 1)
+        return false;
+    
+    // Guards against allocating for a corrupt length
+    long position = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long remaining = ftell(file) - position;
+    fseek(file, position, SEEK_SET);
+    if (count > (uint64_t)remaining / sizeof(complex<double>))
+        return false;
+    
+    values.resize(count);
+    return !count || fread(&values[0], sizeof(complex<double>), count, file) == count;
+}
+
+bool Simulation::voltagesChanged(vector< complex<double> > &previousVoltages) {
+    bool changed = (previousVoltages.size() != _circuit.size() * 2);
+    previousVoltages.resize(_circuit.size() * 2);
+    
+    for (size_t i = 0; i < _circuit.size(); i++) {
+        Resistor *resistor = dynamic_cast<Resistor *>(_circuit[i]);
+        if (!resistor)
+            continue;
         
-        
-        // Close the output stream before returning
-        output.close();
-        if (_verbose) {
-            cout << " File successfully written to:" << endl;
-            cout << path << endl;
+        complex<double> voltages[2] = {resistor->getLeftVoltage(), resistor->getRightVoltage()};
+        for (int port = 0; port < 2; port++) {
+            if (abs(voltages[port] - previousVoltages[2*i + port]) > METRICS_TOLERANCE)
+                changed = true;
+            previousVoltages[2*i + port] = voltages[port];
         }
-    } else {
-        cout << "ERROR : Could not generate <" << path << ">." << endl;
-        return;
     }
     
-    return;
+    return changed;
 }
@@ -15,6 +15,53 @@
 //  distribution feeders and supply them with power values for simulation.
 
 #include "storage.h"
+#include "resultStore.h"
+#include "csvWriter.h"
+#include "summary.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memoryTracker.h"
+#include "log.h"
+#include "progressReporter.h"
+
+// Largest change of any node voltage (in V) at which the reference solver
+// stops iterating the constant power loads, and its iteration limit
+#define REFERENCE_TOLERANCE     1e-12
+#define REFERENCE_ITERATIONS    1000
+
+// Consumer voltage relative to the nominal one below which a converged
+// solution is the collapsed one, with no power delivered or exported
+#define REFERENCE_COLLAPSE      0.01
+
+// Consecutive growing changes after which a reference solve with a voltage
+// ceiling is taken to diverge
+#define REFERENCE_DIVERGENCE    3
+
+// Band of house voltages relative to the nominal one that the linear
+// solver screens for. A scenario with any house within the margin of either
+// limit is solved again by the reference solver, and every SCREENING_CHECK
+// linear solve is compared against it to measure the error
+#define SCREENING_LOWER         0.90
+#define SCREENING_UPPER         1.10
+#define SCREENING_MARGIN        0.02
+#define SCREENING_CHECK         100
+
+// Ways in which an assembled circuit can be solved
+enum solverBackend {
+    InterrogationSolver     = 0,    // iterative interrogation of the elements
+    ReferenceSolver         = 1,    // nodal analysis in long double precision
+    LinearSolver            = 2,    // single pass at nominal voltage, screened
+    NumberOfSolvers         = 3,
+};
+
+// Linear solves of a simulation and how they compared to full ones
+struct screeningStatistics {
+    long scenarios;         // solved linearly
+    long resolved;          // close to a limit and solved again in full
+    long checked;           // compared to a full solve, the resolved included
+    double maxError;        // largest voltage error at any house in V
+    double errorSum;        // sum of the largest error of every compared one
+};
 
 class Simulation {
 protected:
@@ -49,12 +96,69 @@ protected:
     // The entire circuit will be stored in this vector
     vector<Element *> _circuit;
     
+    // Phase of each element in the circuit, zero for the return line
+    vector<int> _elementPhases;
+    
+    // Connection order and consumers per phase the circuit was wired with
+    vector<int> _assembledOrder;
+    vector<size_t> _assembledCounts;
+    
+    // Elements with fixed voltages through which the computation is entered
+    vector<Element *> _entryElements;
+    
     bool _verbose;
     
+    // Suppresses all regular output, used for copies run on worker threads
+    bool _silent;
+    
+    // Timers and counters of all stages, NULL if nothing is measured
+    Metrics *_metrics;
+    
+    // Backend used by solve()
+    int _solver;
+    
+    // Consumer voltage above which the reference solver gives up early, none
+    // if zero
+    double _voltageCeiling;
+    
+    // Counts the solver passes, NULL if progress is not reported
+    ProgressReporter *_progress;
+    
+    // Whether the last solve converged, and the node voltages of the last
+    // converged reference solve from which the next one starts
+    bool _converged;
+    vector< complex<long double> > _referenceVoltages;
+    
+    screeningStatistics _screening;
+    
 public:
     Simulation(bool verbose = false);
+    
+    // Creates a silent simulation with the same phases, voltages, impedances
+    // and powers as the given one. The circuit itself is not copied
+    Simulation(Simulation *setup);
     ~Simulation();
 
+    // Sets the metrics that all stages report to. The simulation does not
+    // take ownership and copies are not measured unless given their own
+    void setMetrics(Metrics *metrics);
+    Metrics *getMetrics();
+    
+    // Sets the reporter each solver pass advances. The simulation does not
+    // take ownership and copies do not report
+    void setProgress(ProgressReporter *progress);
+    
+    // Chooses the backend that solve() evaluates the circuit with
+    void setSolver(int solver);
+    int getSolver();
+    static const char *solverName(int solver);
+    
+    // Lets the reference solver stop without converging as soon as a
+    // consumer voltage settles above the ceiling or the iteration diverges,
+    // for searches that only need to know whether a limit is kept. Zero
+    // always solves to the end
+    void setVoltageCeiling(double ceiling);
+    
     // Sets and gets the number of phases
     void setPhases(int phases);
     int getPhases();
@@ -63,6 +167,11 @@ public:
     
     void setSource(complex<double> vcc = complex<double> (240.0, 0.0));
     void setSink(complex<double> vss = complex<double> (0.0, 0.0));
+    complex<double> getSource();
+    complex<double> getSink();
+    
+    // Source voltage of a phase (counted from one), rotated by 2π/phases
+    complex<double> phaseSource(int phase);
     
     void addFeederImpedanceForPhase(complex<double> impedance, int phase = 1);
     void addReturnImpedance(complex<double> impedance);
@@ -73,16 +182,99 @@ public:
     void addPowerToPhase(complex<double> power, int phase = 1);
     void addPowerToPhase(double power, double powerFactor, int phase = 1, bool isInductive = true);
     
+    // Removes all house powers and the connection order while keeping the
+    // feeder and return line impedances
+    void clearPowers();
+    
+    // Phase and power of a connection, counted from zero along the feeder.
+    // Setting a power only changes the power matrix, updatePowers() applies
+    // it to an assembled circuit
+    int getConnectionCount();
+    int getConnectionPhase(int connection);
+    complex<double> getConnectionPower(int connection);
+    void setConnectionPower(int connection, complex<double> power);
+    
     // Starts the simulation
     void start();
     
+    // The individual stages of start(). validate() checks that the feeder,
+    // return line and powers match, assemble() builds the circuit and solve()
+    // evaluates the assembled circuit
+    bool validate();
+    void assemble();
+    void solve();
+    
+    // Applies the current power matrix to the consumers of an already
+    // assembled circuit. Returns false if the circuit does not match the
+    // connection order, in which case it needs to be assembled again
+    bool updatePowers();
+    
+    // False if the last solve did not converge
+    bool hasConverged();
+    
+    // Accounting of the linear solves so far
+    screeningStatistics getScreening();
+    
     // Saves the feeder with all voltagses in an external CSV file
     // as path pass: "out" so store the output in the current directory
     void saveFeeders(string path, bool saveComplex = false);
     
     void saveSubstation(string path, bool saveComplex = false);
+    
+    // Appends the state of every element as one sample to a binary result
+    // store. The store is opened with the circuit's elements if needed
+    void saveResults(ResultStore *store, int sample = 0);
+    
+    // Adds the state of every element as one sample to a summary. The
+    // summary is set up with the circuit's elements if needed
+    void summariseResults(Summary *summary);
+    
+    // Copies the port voltages, current and impedance of every element in
+    // circuit order: the return line first, then each phase's consumers
+    // and feeder segments in pairs
+    void getElementStates(vector< complex<double> > &leftVoltages, vector< complex<double> > &rightVoltages, vector< complex<double> > &currents, vector< complex<double> > &impedances);
+    
+    // Voltage magnitude across the consumer of every connection, in
+    // connection order
+    void getConnectionVoltages(vector<double> &voltages);
+    
+    // Writes the phases, voltages, impedances, powers and connection order
+    // in binary to an open file, and reads them back. Reading replaces the
+    // whole setup, feederChanged is false if only the powers differ, so an
+    // assembled circuit can be kept and updated
+    bool writeScenario(FILE *file);
+    bool readScenario(FILE *file, bool &feederChanged);
 protected:
+    // Writes the port values of the given elements into a CSV file
+    void saveElements(string path, vector<Resistor *> elements, bool saveComplex);
+    
+    // The backends of solve()
+    void solveInterrogation();
+    void solveReference();
+    void solveLinear();
     
+    // Solves a linear solution again by the reference solver if a house is
+    // close to a limit or it is due to be checked, and records the error
+    void screenLinear();
+    
+    // Branches of an assembled circuit in the form of the nodal solvers: the
+    // consumer of each connection, the previous connection on its phase,
+    // segment impedances and the signed power drawn. False if the circuit
+    // does not have this form
+    bool collectBranches(vector<size_t> &consumerOf, vector<long> &previousOnPhase, vector< complex<long double> > &returnImpedances, vector< complex<long double> > &feederImpedances, vector<long double> &powers);
+    
+    // Writes node voltages (return node 2k, feeder node 2k+1 of connection k)
+    // and consumer resistances back into the elements
+    void storeNodeVoltages(vector< complex<long double> > &voltages, vector<long double> &loads, vector<size_t> &consumerOf, vector<long> &previousOnPhase, vector< complex<long double> > &returnImpedances, vector< complex<long double> > &feederImpedances);
+    
+    // Binary form of a vector as its length followed by its values
+    static void writeValues(FILE *file, vector< complex<double> > &values);
+    static bool readValues(FILE *file, vector< complex<double> > &values);
+    
+    // Compares all port voltages against those of the previous iteration
+    // and stores them for the next. Returns true if any of them changed
+    bool voltagesChanged(vector< complex<double> > &previousVoltages);
+
 };
 
 #endif /* defined(__DiCOMO__simulation__) */
@@ -11,13 +11,34 @@
 Submitter::Submitter(bool verbose) {
     // Generates new instance of simulation
     _simulation = new Simulation(verbose);
+    _irishData = NULL;
     
     _verbose = verbose;
     
     _startHouse = 0;
     _feederLenth = 0;
     _sample = 0;
+    _sampleCount = 0;
     _powerFactor = 1.0;
+    _binaryOutput = false;
+    _summaryOutput = false;
+    _threads = 1;
+    _profileStorage = DoubleProfiles;
+    _verifyProfileStorage = false;
+    _metrics = NULL;
+    _progress = NULL;
+    _recorder = NULL;
+    _balanceIterations = 0;
+    _balanceObjective = ReturnLossObjective;
+    _hostingMode = -1;
+    _voltageLimit = 0.0;
+    _plfTimeOfDay = -1;
+    _reduceFirst = 0;
+    _reduceLast = 0;
+    _faultImpedance = -1.0;
+    _representativeDays = 0;
+    _diversityGroups = -1;
+    memset(&_screening, 0, sizeof(screeningStatistics));
 }
 
 Submitter::~Submitter() {
@@ -25,6 +46,10 @@ Submitter::~Submitter() {
     if (_simulation)
         _simulation->~Simulation();
     _simulation = NULL;
+    
+    delete _metrics;
+    delete _progress;
+    delete _recorder;
 }
 
 void Submitter::setValues(int argc, const char * argv[]) {
@@ -43,10 +68,89 @@ void Submitter::setValues(int argc, const char * argv[]) {
             }
             
             switch (argv[i][1]) {
+                case '-':
+                    // Long flags
+                    if (string(argv[i]) == "--metrics") {
+                        // Next the metrics output path will be set up
+                        settingCounter = MetricsFile;
+                    } else if (string(argv[i]) == "--trace") {
+                        // Next the trace output path will be set up
+                        settingCounter = TraceFile;
+                    } else if (string(argv[i]) == "--memory") {
+                        // Next the memory accounting output path will be set up
+                        settingCounter = MemoryFile;
+                    } else if (string(argv[i]) == "--log") {
+                        // Next the log level will be set up
+                        settingCounter = LogLevel;
+                    } else if (string(argv[i]) == "--progress") {
+                        // Next the progress output path will be set up
+                        settingCounter = ProgressFile;
+                    } else if (string(argv[i]) == "--record") {
+                        // Next the path scenarios are recorded to will be set up
+                        settingCounter = RecordFile;
+                    } else if (string(argv[i]) == "--replay") {
+                        // Next the path of recorded scenarios will be set up
+                        settingCounter = ReplayFile;
+                    } else if (string(argv[i]) == "--balance") {
+                        // Next the iterations of the phase balancing will be set up
+                        settingCounter = Balance;
+                    } else if (string(argv[i]) == "--objective") {
+                        // Next the phase balancing objective will be set up
+                        settingCounter = Objective;
+                    } else if (string(argv[i]) == "--solver") {
+                        // Next the solver backend will be set up
+                        settingCounter = Solver;
+                    } else if (string(argv[i]) == "--hosting") {
+                        // Next the hosting capacity mode will be set up
+                        settingCounter = Hosting;
+                    } else if (string(argv[i]) == "--vmax") {
+                        // Next the voltage limit of the hosting capacity will be set up
+                        settingCounter = VoltageLimit;
+                    } else if (string(argv[i]) == "--sensitivity") {
+                        // Next the path of the voltage sensitivities will be set up
+                        settingCounter = SensitivityFile;
+                    } else if (string(argv[i]) == "--plf") {
+                        // Next the time of day of the probabilistic load flow will be set up
+                        settingCounter = PointEstimates;
+                    } else if (string(argv[i]) == "--reduce") {
+                        // Next the retained range of the network reduction will be set up
+                        settingCounter = Reduction;
+                    } else if (string(argv[i]) == "--faults") {
+                        // Next the impedance of the short circuits will be set up
+                        settingCounter = FaultImpedance;
+                    } else if (string(argv[i]) == "--harmonics") {
+                        // Next the spectra of the harmonic load flow will be set up
+                        settingCounter = HarmonicSpectra;
+                    } else if (string(argv[i]) == "--days") {
+                        // Next the number of representative days will be set up
+                        settingCounter = RepresentativeDays;
+                    } else if (string(argv[i]) == "--diversity") {
+                        // Next the number of random groups of the diversity analysis will be set up
+                        settingCounter = DiversityGroups;
+                    } else {
+                        cout << "ERROR : Can not interpret <" << argv[i] << ">" << endl;
+                        settingCounter = Error;
+                    }
+                    break;
+                    
                 case 'a':
                     about();
                     break;
                 
+                case 'b':
+                    // Write time-series results to a binary result store
+                    _binaryOutput = true;
+                    if (_verbose)
+                        cout << setw(30) << "Binary output: " << "on" << endl;
+                    break;
+                    
+                case 'c':
+                    // Next the compact profile storage will be set up
+                    // "-cv" additionally reports the conversion error
+                    _verifyProfileStorage = (argv[i][2] == 'v');
+                    settingCounter = ProfileStorage;
+                    break;
+                    
                 case 'd':
                     // Next the sample counter (delay) will be set up
                     settingCounter = Sample;
@@ -57,6 +161,13 @@ void Submitter::setValues(int argc, const char * argv[]) {
                     settingCounter = PowerFactor;
                     break;
                     
+                case 'g':
+                    // Only summarise the time-series results
+                    _summaryOutput = true;
+                    if (_verbose)
+                        cout << setw(30) << "Summary output: " << "on" << endl;
+                    break;
+                    
                 case 'h':
                     if (argc > 2) {
                         // If the help was intended for a previous flag
@@ -73,11 +184,21 @@ void Submitter::setValues(int argc, const char * argv[]) {
                     settingCounter = IrishDataSetup;
                     break;
                     
+                case 'j':
+                    // Next the number of worker threads is passed
+                    settingCounter = Threads;
+                    break;
+                    
                 case 'l':
                     // Next the feeder lenth is passed
                     settingCounter = FeederLength;
                     break;
                     
+                case 'n':
+                    // Next the number of samples for a time-series is passed
+                    settingCounter = SampleCount;
+                    break;
+                    
                 case 'o':
                     // Next the output file path will be stored
                     settingCounter = OutputFile;
@@ -88,6 +209,11 @@ void Submitter::setValues(int argc, const char * argv[]) {
                     settingCounter = Phases;
                     break;
                     
+                case 'q':
+                    // Next a query over stored results is passed
+                    settingCounter = Query;
+                    break;
+                    
                 case 'r':
                     run();
                     break;
@@ -152,6 +278,7 @@ void Submitter::setValues(int argc, const char * argv[]) {
 
                     case IrishDataSetup:
                         _irishData = new IrishData(argv[i]);
+                        _irishData->setStorage(_profileStorage, _verifyProfileStorage);
                         _irishData->loadData();
                         if (_verbose)
                             cout << setw(30) << "Irish Data loaded from: " << argv[i] << endl;
@@ -181,18 +308,218 @@ void Submitter::setValues(int argc, const char * argv[]) {
                             cout << setw(30) << "Sample set to: " << argv[i] << endl;
                         break;
                     
+                    case SampleCount:
+                        _sampleCount = atoi(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Sample count set to: " << argv[i] << endl;
+                        break;
+                    
+                    case Query:
+                        query(argv[i]);
+                        break;
+                    
+                    case Threads:
+                        _threads = max(1, atoi(argv[i]));
+                        if (_verbose)
+                            cout << setw(30) << "Threads set to: " << argv[i] << endl;
+                        break;
+                    
                     case PowerFactor:
                         _powerFactor = atof(argv[i]);
                         if (_verbose)
                             cout << setw(30) << "Power factor set to: " << argv[i] << endl;
                         break;
                         
+                    case ProfileStorage:
+                        if (string(argv[i]) == "float") {
+                            _profileStorage = FloatProfiles;
+                        } else if (string(argv[i]) == "fixed16") {
+                            _profileStorage = Fixed16Profiles;
+                        } else if (string(argv[i]) == "fixed32") {
+                            _profileStorage = Fixed32Profiles;
+                        } else if (string(argv[i]) == "double") {
+                            _profileStorage = DoubleProfiles;
+                        } else {
+                            cout << "ERROR : Unknown profile storage <" << argv[i] << ">" << endl;
+                            break;
+                        }
+                        if (_verbose)
+                            cout << setw(30) << "Profile storage set to: " << argv[i] << endl;
+                        break;
+                        
                     case OutputFile:
                         _outputFilePath = argv[i];
                         if (_verbose)
                             cout << setw(30) << "Output path set to: " << _outputFilePath << endl;
                         break;
                         
+                    case MetricsFile:
+                        _metricsFilePath = argv[i];
+                        if (!_metrics)
+                            _metrics = new Metrics();
+                        if (_simulation)
+                            _simulation->setMetrics(_metrics);
+                        if (_verbose)
+                            cout << setw(30) << "Metrics path set to: " << _metricsFilePath << endl;
+                        break;
+                        
+                    case TraceFile:
+                        _traceFilePath = argv[i];
+                        Trace::enable();
+                        if (_verbose)
+                            cout << setw(30) << "Trace path set to: " << _traceFilePath << endl;
+                        break;
+                        
+                    case MemoryFile:
+                        _memoryFilePath = argv[i];
+                        MemoryTracker::enable();
+                        if (_verbose)
+                            cout << setw(30) << "Memory path set to: " << _memoryFilePath << endl;
+                        break;
+                        
+                    case LogLevel:
+                        if (Log::parseLevel(argv[i]) < 0) {
+                            cout << "ERROR : Unknown log level <" << argv[i] << ">" << endl;
+                            break;
+                        }
+                        Log::setLevel(Log::parseLevel(argv[i]));
+                        if (_verbose)
+                            cout << setw(30) << "Log level set to: " << Log::levelName(Log::getLevel()) << endl;
+                        break;
+                        
+                    case ProgressFile:
+                        delete _progress;
+                        _progress = new ProgressReporter(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Progress path set to: " << argv[i] << endl;
+                        break;
+                        
+                    case RecordFile:
+                        delete _recorder;
+                        _recorder = new Replay(argv[i]);
+                        if (!_recorder->create()) {
+                            delete _recorder;
+                            _recorder = NULL;
+                            break;
+                        }
+                        if (_verbose)
+                            cout << setw(30) << "Record path set to: " << argv[i] << endl;
+                        break;
+                        
+                    case ReplayFile:
+                        _replayFilePath = argv[i];
+                        if (_verbose)
+                            cout << setw(30) << "Replay path set to: " << _replayFilePath << endl;
+                        break;
+                        
+                    case Balance:
+                        _balanceIterations = max(0, atoi(argv[i]));
+                        if (_verbose)
+                            cout << setw(30) << "Balancing iterations set to: " << argv[i] << endl;
+                        break;
+                        
+                    case Objective:
+                        if (PhaseBalancer::parseObjective(argv[i]) < 0) {
+                            cout << "ERROR : Unknown objective <" << argv[i] << ">" << endl;
+                            break;
+                        }
+                        _balanceObjective = PhaseBalancer::parseObjective(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Objective set to: " << argv[i] << endl;
+                        break;
+                        
+                    case Solver: {
+                        int solver = 0;
+                        while (solver < NumberOfSolvers && string(argv[i]) != Simulation::solverName(solver))
+                            solver++;
+                        if (solver == NumberOfSolvers) {
+                            cout << "ERROR : Unknown solver <" << argv[i] << ">" << endl;
+                            break;
+                        }
+                        _simulation->setSolver(solver);
+                        if (_verbose)
+                            cout << setw(30) << "Solver set to: " << argv[i] << endl;
+                        break;
+                    }
+                        
+                    case Hosting:
+                        if (HostingCapacity::parseMode(argv[i]) < 0) {
+                            cout << "ERROR : Unknown hosting capacity mode <" << argv[i] << ">" << endl;
+                            break;
+                        }
+                        _hostingMode = HostingCapacity::parseMode(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Hosting capacity set to: " << argv[i] << endl;
+                        break;
+                        
+                    case VoltageLimit:
+                        _voltageLimit = max(0.0, atof(argv[i]));
+                        if (_verbose)
+                            cout << setw(30) << "Voltage limit set to: " << argv[i] << endl;
+                        break;
+                        
+                    case SensitivityFile:
+                        _sensitivityFilePath = argv[i];
+                        if (_verbose)
+                            cout << setw(30) << "Sensitivity path set to: " << _sensitivityFilePath << endl;
+                        break;
+                        
+                    case PointEstimates:
+                        if (atoi(argv[i]) < 0 || atoi(argv[i]) >= IRISH_SAMPLES_PER_DAY) {
+                            cout << "ERROR : Time of day must lie between 0 and " << IRISH_SAMPLES_PER_DAY-1 << endl;
+                            break;
+                        }
+                        _plfTimeOfDay = atoi(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Load flow time of day set to: " << argv[i] << endl;
+                        break;
+                        
+                    case Reduction:
+                        if (!NetworkReduction::parseRange(argv[i], _reduceFirst, _reduceLast)) {
+                            cout << "ERROR : Retained range must be given as <first:last>" << endl;
+                            _reduceFirst = _reduceLast = 0;
+                            break;
+                        }
+                        if (_verbose)
+                            cout << setw(30) << "Retained houses set to: " << argv[i] << endl;
+                        break;
+                        
+                    case FaultImpedance:
+                        if (atof(argv[i]) < 0.0) {
+                            cout << "ERROR : Fault impedance must not be negative" << endl;
+                            break;
+                        }
+                        _faultImpedance = atof(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Fault impedance set to: " << argv[i] << endl;
+                        break;
+                        
+                    case HarmonicSpectra:
+                        _harmonicsPath = argv[i];
+                        if (_verbose)
+                            cout << setw(30) << "Harmonic spectra set to: " << _harmonicsPath << endl;
+                        break;
+                        
+                    case RepresentativeDays:
+                        if (atoi(argv[i]) < 1) {
+                            cout << "ERROR : At least one representative day is needed" << endl;
+                            break;
+                        }
+                        _representativeDays = atoi(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Representative days set to: " << argv[i] << endl;
+                        break;
+                        
+                    case DiversityGroups:
+                        if (atoi(argv[i]) < 0) {
+                            cout << "ERROR : The number of random groups can not be negative" << endl;
+                            break;
+                        }
+                        _diversityGroups = atoi(argv[i]);
+                        if (_verbose)
+                            cout << setw(30) << "Random groups set to: " << argv[i] << endl;
+                        break;
+                        
                     default:
                         break;
                 }
@@ -237,14 +564,39 @@ void Submitter::help(const char *argv) {
         cout << " -t                   verbose" << endl;
         cout << " -a                   about" << endl;
         cout << " -h                   help" << endl;
+        cout << " -c<v> <type>         compact profile storage" << endl;
         cout << " -i    <path>         irish data" << endl;
         cout << " -s    <+ve num>      start house" << endl;
         cout << " -d    <+ve num>      sample dalay" << endl;
+        cout << " -n    <+ve num>      number of samples" << endl;
         cout << " -o    <path>         output data" << endl;
+        cout << " -b                   binary output" << endl;
+        cout << " -g                   summary output" << endl;
+        cout << " -j    <+ve num>      threads" << endl;
         cout << " -p    <+ve num>      phases" << endl;
         cout << " -v<n> <+ve num>      voltages" << endl;
         cout << " -l    <+ve num>      length of feeder(s)" << endl;
         cout << " -r                   run" << endl;
+        cout << " -q    <query>        query stored results" << endl;
+        cout << " --metrics <path>     metrics output" << endl;
+        cout << " --trace <path>       trace output" << endl;
+        cout << " --memory <path>      memory accounting output" << endl;
+        cout << " --log <level>        log level" << endl;
+        cout << " --progress <path>    progress output" << endl;
+        cout << " --record <path>      record scenarios" << endl;
+        cout << " --replay <path>      replay scenarios" << endl;
+        cout << " --balance <+ve num>  balance phases" << endl;
+        cout << " --objective <name>   balancing objective" << endl;
+        cout << " --solver <name>      solver backend" << endl;
+        cout << " --hosting <mode>     PV hosting capacity" << endl;
+        cout << " --vmax <+ve num>     hosting voltage limit" << endl;
+        cout << " --sensitivity <path> voltage sensitivities" << endl;
+        cout << " --plf <+ve num>      probabilistic load flow" << endl;
+        cout << " --reduce <first:last> network reduction" << endl;
+        cout << " --faults <+ve num>   short circuits" << endl;
+        cout << " --harmonics <path>   harmonic load flow" << endl;
+        cout << " --days <+ve num>     representative days" << endl;
+        cout << " --diversity <+ve num> load diversity" << endl;
         return;
     }
     
@@ -292,6 +644,23 @@ void Submitter::help(const char *argv) {
             cout << "commas like so: \"data folder/data file.txt\"." << endl;
             break;
             
+        case 'c':
+            cout << "-c<v> <type>" << endl;
+            cout << endl;
+            cout << "Chooses how the Irish data is held in memory. The type" << endl;
+            cout << "may be 'double' (default), 'float', 'fixed16' or 'fixed32'" << endl;
+            cout << "where the fixed-point types store the number of 0.001kWh" << endl;
+            cout << "steps and the step size only once. Values are widened to" << endl;
+            cout << "double when applied to the simulation. Must be passed" << endl;
+            cout << "before the '-i' flag. E.g." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -c fixed16 -i data.txt" << endl;
+            cout << endl;
+            cout << "Passing 'v' as in '-cv' additionally reports the largest" << endl;
+            cout << "conversion error against the double values." << endl;
+            cout << endl;
+            break;
+            
         case 's':
             cout << "-s    <+ve num>" << endl;
             cout << endl;
@@ -335,6 +704,50 @@ void Submitter::help(const char *argv) {
             cout << endl;
             break;
             
+        case 'n':
+            cout << "-n    <+ve num>" << endl;
+            cout << endl;
+            cout << "Runs a time-series over this many consecutive samples" << endl;
+            cout << "of the Irish data, starting at the sample delay set with" << endl;
+            cout << "'-d'. The circuit is assembled once and only the house" << endl;
+            cout << "powers are updated between samples. Each sample is saved" << endl;
+            cout << "to '<output>_<sample>' unless '-b' is passed." << endl;
+            cout << endl;
+            break;
+            
+        case 'b':
+            cout << "-b" << endl;
+            cout << endl;
+            cout << "Writes the results of a time-series ('-n') into a single" << endl;
+            cout << "binary result store '<output>.dcr' instead of one CSV per" << endl;
+            cout << "sample. The store keeps the voltages, current and power" << endl;
+            cout << "of every element for every sample in columns, so it can" << endl;
+            cout << "be read back by mapping the file into memory." << endl;
+            cout << endl;
+            break;
+            
+        case 'g':
+            cout << "-g" << endl;
+            cout << endl;
+            cout << "Summarises a time-series ('-n') instead of saving every" << endl;
+            cout << "sample. For each house the minimum, maximum, 5%, 50% and" << endl;
+            cout << "95% voltage and the hours outside +/-10% of the nominal" << endl;
+            cout << "voltage are kept, for each line segment its peak current" << endl;
+            cout << "and for each phase and the return line the energy lost." << endl;
+            cout << "The summary is saved to '<output>_houses.csv'," << endl;
+            cout << "'<output>_lines.csv' and '<output>_losses.csv'." << endl;
+            cout << endl;
+            break;
+            
+        case 'j':
+            cout << "-j    <+ve num>" << endl;
+            cout << endl;
+            cout << "Number of threads a summarised time-series is split" << endl;
+            cout << "across. Each thread solves its own copy of the circuit" << endl;
+            cout << "for a block of samples and the summaries are merged." << endl;
+            cout << endl;
+            break;
+            
         case 'p':
             cout << "-p    <+ve num>" << endl;
             cout << endl;
@@ -380,6 +793,190 @@ void Submitter::help(const char *argv) {
             cout << endl;
             break;
             
+        case 'q':
+            cout << "-q    <query>" << endl;
+            cout << endl;
+            cout << "Answers a query over the binary results '<output>.dcr'" << endl;
+            cout << "written by '-b', so '-o' must be passed first. Elements" << endl;
+            cout << "are given by name and samples by their number in the" << endl;
+            cout << "Irish data, as a single sample 'n', a range 'a:b' or as" << endl;
+            cout << "weeks 'wA:B'. Quantities are 'voltage', 'current' and" << endl;
+            cout << "'power'. E.g." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -o out -q \"voltage consumer_217 w3:5\"" << endl;
+            cout << " ./DiCOMO -o out -q \"voltage consumer < 216 4100\"" << endl;
+            cout << endl;
+            cout << "The first query builds an index '<output>.dcr.dci' that" << endl;
+            cout << "lets later queries skip all blocks without a match." << endl;
+            cout << endl;
+            break;
+            
+        case '-':
+            cout << "--metrics <path>" << endl;
+            cout << endl;
+            cout << "Measures the run and writes the wall-clock time spent in" << endl;
+            cout << "validation, assembly, solve and save as well as solver" << endl;
+            cout << "counters (state updates, impedance recursions and their" << endl;
+            cout << "depth, peak worklist size, iterations to convergence) as" << endl;
+            cout << "JSON to the path. Must be passed before '-r'. Threads of" << endl;
+            cout << "a time-series add up their times and counters. E.g." << endl;
+            cout << endl;
+            cout << " ./DiCOMO --metrics out.json -i data.txt -l 50 -r" << endl;
+            cout << endl;
+            cout << "--trace <path>" << endl;
+            cout << endl;
+            cout << "Records a timeline of loading, assembly, every solve and" << endl;
+            cout << "every write on each thread and saves it as trace-event" << endl;
+            cout << "JSON, which can be opened in chrome://tracing or on" << endl;
+            cout << "ui.perfetto.dev. Pass it first to include the loading of" << endl;
+            cout << "the Irish data. E.g." << endl;
+            cout << endl;
+            cout << " ./DiCOMO --trace run.json -i data.txt -l 50 -n 48 -g -j 4 -r" << endl;
+            cout << endl;
+            cout << "--memory <path>" << endl;
+            cout << endl;
+            cout << "Counts every heap allocation from here on and writes the" << endl;
+            cout << "allocations and bytes per stage (load, assemble, solve," << endl;
+            cout << "write), the bytes per element type and the peak resident" << endl;
+            cout << "set size as JSON. Pass it first to include loading." << endl;
+            cout << endl;
+            cout << "--log <level>" << endl;
+            cout << endl;
+            cout << "Sets how much is printed: error, warning, info (default)," << endl;
+            cout << "debug or trace, or 0 to 4. Debug adds the state of every" << endl;
+            cout << "element after a solve, trace a line per solver pass." << endl;
+            cout << "Both are only compiled into debug builds. E.g." << endl;
+            cout << endl;
+            cout << " ./DiCOMO --log debug -i data.txt -l 5 -r" << endl;
+            cout << endl;
+            cout << "--progress <path>" << endl;
+            cout << endl;
+            cout << "Appends a JSON line once a second with the solver passes" << endl;
+            cout << "(or time-series samples) done, their rate, the estimated" << endl;
+            cout << "seconds remaining and the resident memory. Written from a" << endl;
+            cout << "side thread, 'stderr' writes to the standard error stream." << endl;
+            cout << endl;
+            cout << "--record <path>" << endl;
+            cout << "--replay <path>" << endl;
+            cout << endl;
+            cout << "Records every solved scenario (phases, voltages, feeder" << endl;
+            cout << "and return impedances, applied powers and connection" << endl;
+            cout << "order) to a binary file. Replaying it with '-r' solves" << endl;
+            cout << "exactly the same scenarios again without the Irish data," << endl;
+            cout << "so builds can be profiled and compared on equal inputs." << endl;
+            cout << endl;
+            cout << " ./DiCOMO --record day.rpl -i data.txt -l 50 -n 48 -r" << endl;
+            cout << " ./DiCOMO --replay day.rpl -o replayed -r" << endl;
+            cout << endl;
+            cout << "--balance <+ve num>" << endl;
+            cout << "--objective <loss|drop>" << endl;
+            cout << endl;
+            cout << "Searches the phase each house is connected to for the" << endl;
+            cout << "given number of iterations by simulated annealing over" << endl;
+            cout << "the samples chosen with '-d' and '-n'. Minimises the" << endl;
+            cout << "return line loss (default) or the worst voltage drop." << endl;
+            cout << "With '-j' every iteration rates one candidate per thread." << endl;
+            cout << "Writes the initial and balanced phase of every house." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 10 -n 8 -j 4 --balance 200 -r" << endl;
+            cout << endl;
+            cout << "--solver <interrogation|reference|linear>" << endl;
+            cout << endl;
+            cout << "Chooses how circuits are solved: by interrogating the" << endl;
+            cout << "elements (default), by the nodal reference solver or by" << endl;
+            cout << "a single linear pass at nominal voltage for screening." << endl;
+            cout << "Linear scenarios with a house within 2% of 90% or 110%" << endl;
+            cout << "of nominal are solved again by the reference solver, as" << endl;
+            cout << "is every hundredth, and the error is reported per run." << endl;
+            cout << endl;
+            cout << "--hosting <house|uniform>" << endl;
+            cout << "--vmax <+ve num>" << endl;
+            cout << endl;
+            cout << "Searches the rooftop PV export each house (house) or all" << endl;
+            cout << "houses at once (uniform) can host before the voltage at" << endl;
+            cout << "any house exceeds '--vmax' (default 110% of nominal)." << endl;
+            cout << "The lowest capacity under the samples chosen with '-d'" << endl;
+            cout << "and '-n' is kept. Always solved by the reference solver." << endl;
+            cout << "With '-j' the houses are split over the threads. Houses" << endl;
+            cout << "that keep the limit up to 100 kW are written as >=100000." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 10 -n 8 -j 4 --hosting house -r" << endl;
+            cout << endl;
+            cout << "--sensitivity <path>" << endl;
+            cout << endl;
+            cout << "Writes the change of the voltage at every house per W" << endl;
+            cout << "and per var drawn at every house, linearised at the" << endl;
+            cout << "solution of a single run, as a binary matrix file." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 20 --solver reference --sensitivity s.bin -r" << endl;
+            cout << endl;
+            cout << "--plf <+ve num>" << endl;
+            cout << endl;
+            cout << "Estimates mean, deviation, skewness, kurtosis and the" << endl;
+            cout << "1, 5, 50, 95 and 99% percentiles of the voltage at every" << endl;
+            cout << "house at the given half hour of the day (0 to 47). The" << endl;
+            cout << "power of each house is distributed as over all days of" << endl;
+            cout << "the data, and 2 solves per house plus one are needed." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 20 --solver reference --plf 38 -r" << endl;
+            cout << endl;
+            cout << "--reduce <first:last>" << endl;
+            cout << endl;
+            cout << "Keeps the houses from <first> up to but not including" << endl;
+            cout << "<last> (counted along the feeder from zero) and replaces" << endl;
+            cout << "all others by equivalent resistors at the sample chosen" << endl;
+            cout << "with '-d'. The retained houses are then solved for '-n'" << endl;
+            cout << "samples while the others keep their powers, and every" << endl;
+            cout << "solve is compared against one of the full feeder." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 100 -d 30 -n 10 --reduce 120:150 -r" << endl;
+            cout << endl;
+            cout << "--faults <+ve num>" << endl;
+            cout << endl;
+            cout << "Computes a line-to-neutral fault through the given" << endl;
+            cout << "impedance in Ohm (0 for a bolted fault) at every house" << endl;
+            cout << "of a single run. The consumers keep their resistance" << endl;
+            cout << "of the solution, and the network is factorised once" << endl;
+            cout << "for all faults." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 20 --solver reference --faults 0 -r" << endl;
+            cout << endl;
+            cout << "--harmonics <path>" << endl;
+            cout << endl;
+            cout << "Solves the harmonic orders 2 to 50 of a single run on" << endl;
+            cout << "'-j' threads and writes the THD of every house. The" << endl;
+            cout << "CSV file holds rows of connection, order, magnitude" << endl;
+            cout << "relative to the fundamental current and angle in deg." << endl;
+            cout << "Houses without a row, or all with 'typical', draw a" << endl;
+            cout << "typical spectrum of electronic loads." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 20 -j 4 --harmonics typical -r" << endl;
+            cout << endl;
+            cout << "--days <+ve num>" << endl;
+            cout << endl;
+            cout << "Clusters the summed power of the houses over every day" << endl;
+            cout << "of the data into the given number of representative" << endl;
+            cout << "days, each weighted by the days it stands for. Every" << endl;
+            cout << "day is solved to report the error of the energy, the" << endl;
+            cout << "losses, the peak, the lowest voltage and the time" << endl;
+            cout << "below the limit against the representative days." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 20 -j 4 --solver reference --days 6 -r" << endl;
+            cout << endl;
+            cout << "--diversity <+ve num>" << endl;
+            cout << endl;
+            cout << "Computes the coincident peak, the diversity factor and" << endl;
+            cout << "the mean correlation of every block of consecutive" << endl;
+            cout << "houses of the feeder length along the data, and of" << endl;
+            cout << "the given number of random groups, on '-j' threads." << endl;
+            cout << "No circuit is solved. The pairwise correlation of the" << endl;
+            cout << "block from '-s' is written as well. Uses '-n' samples" << endl;
+            cout << "from '-d', or all following it if none are given." << endl;
+            cout << endl;
+            cout << " ./DiCOMO -i data.txt -p 3 -l 10 -j 4 --diversity 100 -r" << endl;
+            cout << endl;
+            break;
+            
         default:
             break;
     }
@@ -406,6 +1003,13 @@ void Submitter::run() {
         return;
     }
     
+    // A replay brings its own scenarios
+    if (!_replayFilePath.empty()) {
+        runReplay();
+        saveMetrics();
+        return;
+    }
+    
     if (!_irishData) {
         cout << "ERROR : The irish data power profile must be used for this type of simulaton" << endl;
         return;
@@ -425,16 +1029,386 @@ void Submitter::run() {
         _simulation->addFeederImpedanceForPhase(complex<double>(0.01*_simulation->getPhases(), 0.0), (i%_simulation->getPhases())+1);
     for (int i = 0; i < _feederLenth; i++)
         _simulation->addReturnImpedance(complex<double>(0.01, 0.0));
+    
+    if (_balanceIterations > 0) {
+        runBalance();
+        saveMetrics();
+        return;
+    }
+    
+    if (_hostingMode >= 0) {
+        runHosting();
+        saveMetrics();
+        return;
+    }
+    
+    if (_plfTimeOfDay >= 0) {
+        runPointEstimate();
+        saveMetrics();
+        return;
+    }
+    
+    if (_reduceLast > _reduceFirst) {
+        runReduction();
+        saveMetrics();
+        return;
+    }
+    
+    if (_representativeDays > 0) {
+        runDays();
+        saveMetrics();
+        return;
+    }
+    
+    if (_diversityGroups >= 0) {
+        runDiversity();
+        saveMetrics();
+        return;
+    }
+    
+    // Time-series take their powers from the Irish data for every sample
+    if (_sampleCount > 0) {
+        if (_progress)
+            _progress->begin("samples", _sampleCount);
+        runTimeSeries();
+        if (_progress)
+            _progress->finish();
+        if (_recorder)
+            _recorder->close();
+        reportScreening();
+        saveMetrics();
+        return;
+    }
 
     for (int i = 0; i < _feederLenth; i++)
 //        dicomo->addPowerToPhase((double)(rand()%350) + 150.0, (double)(rand()%21)/100.0 + 0.8, (i%numberOfPhases)+1);
         _simulation->addPowerToPhase(900, 1.0, (i%_simulation->getPhases())+1);
     
+    if (_recorder) {
+        _recorder->record(_simulation, _sample);
+        _recorder->close();
+    }
+    
+    if (_progress) {
+        _progress->begin("passes", _feederLenth * 3);
+        _simulation->setProgress(_progress);
+    }
     _simulation->start();
+    if (_progress)
+        _progress->finish();
+    
+    if (!_sensitivityFilePath.empty()) {
+        Sensitivity sensitivity;
+        if (sensitivity.compute(_simulation))
+            sensitivity.save(_sensitivityFilePath);
+    }
+    if (_faultImpedance >= 0.0) {
+        ShortCircuit shortCircuit;
+        shortCircuit.setFaultImpedance(_faultImpedance);
+        if (shortCircuit.compute(_simulation))
+            shortCircuit.save(_outputFilePath);
+    }
+    if (!_harmonicsPath.empty()) {
+        HarmonicFlow harmonics;
+        harmonics.setThreads(_threads);
+        if ((_harmonicsPath == "typical" || harmonics.loadSpectra(_harmonicsPath)) && harmonics.compute(_simulation))
+            harmonics.save(_outputFilePath);
+    }
     _simulation->saveFeeders(_outputFilePath, true);
     _simulation->saveSubstation(_outputFilePath, true);
 
+    addScreening(_simulation);
+    _simulation->~Simulation();
+    _simulation = NULL;
+    
+    reportScreening();
+    saveMetrics();
+}
+
+void Submitter::runTimeSeries() {
+    // Summaries are kept in memory and may be split across threads
+    if (_summaryOutput) {
+        vector<Simulation *> simulations;
+        vector<Summary *> summaries;
+        vector<thread> workers;
+        
+        int threads = min(_threads, _sampleCount);
+        int firstSample = _sample;
+        
+        // The setup is complete once the first sample has been applied
+        _simulation->clearPowers();
+        _irishData->applyProfilesToSim(_simulation, _startHouse, _feederLenth, _sample, _powerFactor, _simulation->getPhases());
+        if (!_simulation->validate())
+            return;
+        
+        for (int i = 0; i < threads; i++) {
+            // Split the samples into consecutive blocks
+            int sampleCount = _sampleCount / threads + (i < _sampleCount % threads ? 1 : 0);
+            
+            simulations.push_back(i == 0 ? _simulation : new Simulation(_simulation));
+            summaries.push_back(new Summary());
+            
+            // Each copy is measured separately and merged afterwards
+            if (_metrics && i > 0)
+                simulations[i]->setMetrics(new Metrics());
+            
+            // Circuits are assembled here in order, so element names do not
+            // depend on which thread happens to assemble first
+            simulations[i]->assemble();
+            
+            workers.push_back(thread(&Submitter::summariseSamples, this, simulations[i], firstSample, sampleCount, summaries[i]));
+            
+            firstSample += sampleCount;
+        }
+        
+        // Merge all summaries into the first one
+        for (int i = 0; i < threads; i++) {
+            workers[i].join();
+            if (i > 0) {
+                summaries[0]->merge(summaries[i]);
+                delete summaries[i];
+                
+                if (_metrics) {
+                    _metrics->merge(simulations[i]->getMetrics());
+                    delete simulations[i]->getMetrics();
+                }
+                addScreening(simulations[i]);
+                delete simulations[i];
+            }
+        }
+        
+        summaries[0]->save(_outputFilePath);
+        delete summaries[0];
+        
+        addScreening(_simulation);
+        _simulation->~Simulation();
+        _simulation = NULL;
+        return;
+    }
+    
+    // All samples are appended to one store when binary output is chosen
+    ResultStore *store = NULL;
+    if (_binaryOutput)
+        store = new ResultStore(_outputFilePath + ".dcr");
+    
+    for (int sample = _sample; sample < _sample + _sampleCount; sample++) {
+        if (!solveSample(_simulation, sample))
+            break;
+        
+        if (store) {
+            _simulation->saveResults(store, sample);
+        } else {
+            stringstream pathStream;
+            pathStream << _outputFilePath << "_" << sample;
+            _simulation->saveFeeders(pathStream.str(), true);
+            _simulation->saveSubstation(pathStream.str(), true);
+        }
+    }
+    
+    if (store) {
+        store->close();
+        delete store;
+    }
+    
+    addScreening(_simulation);
     _simulation->~Simulation();
     _simulation = NULL;
+}
+
+bool Submitter::solveSample(Simulation *simulation, int sample) {
+    // Replace the previous sample's powers
+    simulation->clearPowers();
+    _irishData->applyProfilesToSim(simulation, _startHouse, _feederLenth, sample, _powerFactor, simulation->getPhases());
     
+    if (_recorder)
+        _recorder->record(simulation, sample);
+    
+    // Reuse the circuit if possible and only assemble it otherwise
+    if (!simulation->updatePowers()) {
+        if (!simulation->validate())
+            return false;
+        simulation->assemble();
+    }
+    simulation->solve();
+    
+    if (_progress)
+        _progress->advance();
+    
+    return true;
+}
+
+void Submitter::runReplay() {
+    Replay replay(_replayFilePath);
+    if (!replay.open())
+        return;
+    
+    // A single scenario is written like a single run, several like samples
+    // of a time-series
+    uint64_t scenarios = replay.getScenarioCount();
+    if (_progress)
+        _progress->begin("samples", scenarios);
+    
+    int sample = 0;
+    bool feederChanged = false;
+    while (replay.next(_simulation, sample, feederChanged)) {
+        if (feederChanged || !_simulation->updatePowers()) {
+            if (!_simulation->validate())
+                break;
+            _simulation->assemble();
+        }
+        _simulation->solve();
+        
+        if (_progress)
+            _progress->advance();
+        
+        stringstream pathStream;
+        pathStream << _outputFilePath;
+        if (scenarios > 1)
+            pathStream << "_" << sample;
+        _simulation->saveFeeders(pathStream.str(), true);
+        _simulation->saveSubstation(pathStream.str(), true);
+    }
+    
+    if (_progress)
+        _progress->finish();
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runBalance() {
+    PhaseBalancer balancer(_simulation, _irishData, _startHouse, _feederLenth, _sample, _sampleCount, _powerFactor);
+    balancer.setObjective(_balanceObjective);
+    balancer.setIterations(_balanceIterations);
+    balancer.setThreads(_threads);
+    
+    if (balancer.optimise())
+        balancer.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runHosting() {
+    // Consumers can only export under the reference solver
+    if (_simulation->getSolver() != ReferenceSolver)
+        cout << "Hosting capacity is solved by the " << Simulation::solverName(ReferenceSolver) << " solver" << endl;
+    
+    HostingCapacity hosting(_simulation, _irishData, _startHouse, _feederLenth, _sample, _sampleCount, _powerFactor);
+    hosting.setMode(_hostingMode);
+    hosting.setThreads(_threads);
+    hosting.setLimit(_voltageLimit);
+    
+    if (hosting.run())
+        hosting.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runPointEstimate() {
+    PointEstimate estimate(_simulation, _irishData, _startHouse, _feederLenth, _plfTimeOfDay, _powerFactor);
+    estimate.setThreads(_threads);
+    
+    if (estimate.run())
+        estimate.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runReduction() {
+    // The operating point is solved by the reference solver
+    if (_simulation->getSolver() != ReferenceSolver)
+        cout << "Network reduction is solved by the " << Simulation::solverName(ReferenceSolver) << " solver" << endl;
+    
+    NetworkReduction reduction(_simulation, _irishData, _startHouse, _feederLenth, _sample, _sampleCount, _powerFactor);
+    reduction.setRange(_reduceFirst, _reduceLast);
+    
+    if (reduction.run())
+        reduction.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runDays() {
+    DayClustering clustering(_simulation, _irishData, _startHouse, _feederLenth, _powerFactor);
+    clustering.setClusters(_representativeDays);
+    clustering.setThreads(_threads);
+    
+    if (clustering.run())
+        clustering.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::runDiversity() {
+    LoadDiversity diversity(_irishData, _startHouse, _feederLenth, _sample, _sampleCount);
+    diversity.setRandomGroups(_diversityGroups);
+    diversity.setThreads(_threads);
+    
+    if (diversity.run())
+        diversity.save(_outputFilePath);
+    
+    _simulation->~Simulation();
+    _simulation = NULL;
+}
+
+void Submitter::summariseSamples(Simulation *simulation, int firstSample, int sampleCount, Summary *summary) {
+    for (int sample = firstSample; sample < firstSample + sampleCount; sample++) {
+        if (!solveSample(simulation, sample))
+            return;
+        
+        simulation->summariseResults(summary);
+    }
+}
+
+void Submitter::query(string text) {
+    ResultQuery resultQuery(_outputFilePath + ".dcr");
+    if (!resultQuery.open())
+        return;
+    
+    resultQuery.execute(text);
+}
+
+void Submitter::addScreening(Simulation *simulation) {
+    screeningStatistics screening = simulation->getScreening();
+    _screening.scenarios += screening.scenarios;
+    _screening.resolved += screening.resolved;
+    _screening.checked += screening.checked;
+    _screening.maxError = max(_screening.maxError, screening.maxError);
+    _screening.errorSum += screening.errorSum;
+}
+
+void Submitter::reportScreening() {
+    if (_screening.scenarios == 0)
+        return;
+    
+    cout << "Screened " << _screening.scenarios << " scenario(s) linearly, ";
+    cout << _screening.resolved << " close to a limit were solved again" << endl;
+    cout << "Error against " << _screening.checked << " full solve(s) :";
+    if (_screening.checked > 0) {
+        cout << " max " << fixed << setprecision(4) << _screening.maxError << " V";
+        cout << ", mean " << _screening.errorSum / _screening.checked << " V";
+    }
+    cout << endl;
+}
+
+void Submitter::saveMetrics() {
+    if (_metrics && _metrics->save(_metricsFilePath)) {
+        cout << " Metrics written to:" << endl;
+        cout << _metricsFilePath << endl;
+    }
+    
+    if (!_traceFilePath.empty() && Trace::save(_traceFilePath)) {
+        cout << " Trace written to:" << endl;
+        cout << _traceFilePath << endl;
+    }
+    
+    if (!_memoryFilePath.empty() && MemoryTracker::save(_memoryFilePath)) {
+        cout << " Memory accounting written to:" << endl;
+        cout << _memoryFilePath << endl;
+    }
 }
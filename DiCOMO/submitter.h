@@ -15,6 +15,17 @@
 
 #include "simulation.h"
 #include "irishData.h"
+#include "resultQuery.h"
+#include "replay.h"
+#include "phaseBalancer.h"
+#include "hostingCapacity.h"
+#include "sensitivity.h"
+#include "pointEstimate.h"
+#include "networkReduction.h"
+#include "shortCircuit.h"
+#include "harmonicFlow.h"
+#include "dayClustering.h"
+#include "loadDiversity.h"
 
 using namespace std;
 
@@ -29,6 +40,29 @@ enum setter {
     Sample          = 6,
     OutputFile      = 7,
     PowerFactor     = 8,
+    ProfileStorage  = 9,
+    SampleCount     = 10,
+    Threads         = 11,
+    Query           = 12,
+    MetricsFile     = 13,
+    TraceFile       = 14,
+    MemoryFile      = 15,
+    LogLevel        = 16,
+    ProgressFile    = 17,
+    RecordFile      = 18,
+    ReplayFile      = 19,
+    Balance         = 20,
+    Objective       = 21,
+    Solver          = 22,
+    Hosting         = 23,
+    VoltageLimit    = 24,
+    SensitivityFile = 25,
+    PointEstimates  = 26,
+    Reduction       = 27,
+    FaultImpedance  = 28,
+    HarmonicSpectra = 29,
+    RepresentativeDays = 30,
+    DiversityGroups = 31,
 };
 
 class Submitter {
@@ -42,9 +76,81 @@ protected:
     int _startHouse;
     int _feederLenth;
     int _sample;
+    int _sampleCount;
     double _powerFactor;
     string _outputFilePath;
     
+    // Whether time-series results are written to a binary result store
+    bool _binaryOutput;
+    
+    // Whether time-series results are only summarised and on how many
+    // threads the samples are processed
+    bool _summaryOutput;
+    int _threads;
+    
+    // How the Irish data is held in memory and whether the conversion error
+    // is reported. Needs to be known before the data is loaded
+    profileStorage _profileStorage;
+    bool _verifyProfileStorage;
+    
+    // Timers and counters of the run, only measured if a path is given
+    Metrics *_metrics;
+    string _metricsFilePath;
+    
+    // Timeline of the run, only recorded if a path is given
+    string _traceFilePath;
+    
+    // Memory accounting of the run, only tracked if a path is given
+    string _memoryFilePath;
+    
+    // Snapshots of the run's progress, NULL if not reported
+    ProgressReporter *_progress;
+    
+    // Every solved scenario is recorded if a path is given, and a recorded
+    // file is replayed instead of the Irish data if one is given
+    Replay *_recorder;
+    string _replayFilePath;
+    
+    // Iterations of the phase balancing search, none if zero, and what it
+    // minimises
+    int _balanceIterations;
+    int _balanceObjective;
+    
+    // Mode of the hosting capacity search, none if negative, and the highest
+    // voltage allowed at any house (zero for the default)
+    int _hostingMode;
+    double _voltageLimit;
+    
+    // Voltage sensitivities of a single run are written here if given
+    string _sensitivityFilePath;
+    
+    // Time of day (sample within a day) of the probabilistic load flow, none
+    // if negative
+    int _plfTimeOfDay;
+    
+    // Houses retained by the network reduction, from the first up to but not
+    // including the last, none if both are zero
+    int _reduceFirst;
+    int _reduceLast;
+    
+    // Impedance of the line-to-neutral faults of a single run in Ohm, none
+    // if negative
+    double _faultImpedance;
+    
+    // Spectra of the harmonic load flow of a single run, "typical" for the
+    // built-in one and none if empty
+    string _harmonicsPath;
+    
+    // Number of representative days the Irish data is clustered into, none
+    // if zero
+    int _representativeDays;
+    
+    // Number of random groups of the diversity analysis, none if negative
+    int _diversityGroups;
+    
+    // Linear solves of all simulations of the run
+    screeningStatistics _screening;
+    
 public:
     Submitter(bool verbose = false);
     ~Submitter();
@@ -61,6 +167,52 @@ protected:
 
     // Executes the simulation
     void run();
+    
+    // Answers a query over the binary result store of the output path
+    void query(string text);
+    
+    // Executes the simulation for consecutive samples of the Irish data,
+    // reusing the assembled circuit between samples
+    void runTimeSeries();
+    
+    // Applies one sample of the Irish data to a simulation and solves it
+    bool solveSample(Simulation *simulation, int sample);
+    
+    // Solves every scenario of the replay file and writes its results
+    void runReplay();
+    
+    // Searches a better balanced phase assignment over the samples
+    void runBalance();
+    
+    // Searches the PV export every house can host within the voltage limit
+    void runHosting();
+    
+    // Estimates the voltage distribution at every house at a time of day
+    void runPointEstimate();
+    
+    // Reduces the feeder to the retained houses and solves them for the
+    // samples against a full solve
+    void runReduction();
+    
+    // Clusters the days of the Irish data into representative ones and
+    // compares them against solving every day
+    void runDays();
+    
+    // Computes the coincident peaks and diversity factors of groups of
+    // houses of the Irish data
+    void runDiversity();
+    
+    // Summarises a block of consecutive samples, run on worker threads
+    void summariseSamples(Simulation *simulation, int firstSample, int sampleCount, Summary *summary);
+    
+    // Writes the metrics, trace and memory accounting of the run if they
+    // were requested
+    void saveMetrics();
+    
+    // Adds up the linear solves of a simulation before it is deleted, and
+    // reports them for the run
+    void addScreening(Simulation *simulation);
+    void reportScreening();
 };
 
 #endif /* defined(__DiCOMO__submitter__) */
@@ -0,0 +1,289 @@
+//
+//  summary.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "summary.h"
+
+#pragma mark QUANTILE SKETCH
+
+QuantileSketch::QuantileSketch(double lower, double upper, int bins) {
+    _lower = lower;
+    _upper = upper;
+
+    // One extra bin on each side for values outside the range
+    _counts.assign(bins + 2, 0);
+
+    _minimum = INFINITY;
+    _maximum = -INFINITY;
+    _count = 0;
+}
+
+void QuantileSketch::add(double value) {
+    int bins = (int)_counts.size() - 2;
+
+    size_t bin;
+    if (value < _lower) {
+        bin = 0;
+    } else if (value >= _upper) {
+        bin = bins + 1;
+    } else {
+        bin = 1 + (size_t)((value - _lower) / (_upper - _lower) * bins);
+        bin = min(bin, (size_t)bins);
+    }
+
+    _counts[bin]++;
+    _minimum = min(_minimum, value);
+    _maximum = max(_maximum, value);
+    _count++;
+}
+
+void QuantileSketch::merge(const QuantileSketch &sketch) {
+    // Only sketches over the same bins can be merged
+    if (sketch._counts.size() != _counts.size()
+        || sketch._lower != _lower || sketch._upper != _upper) {
+        cout << "ERROR : Can not merge sketches of different ranges." << endl;
+        return;
+    }
+
+    for (size_t i = 0; i < _counts.size(); i++)
+        _counts[i] += sketch._counts[i];
+
+    _minimum = min(_minimum, sketch._minimum);
+    _maximum = max(_maximum, sketch._maximum);
+    _count += sketch._count;
+}
+
+double QuantileSketch::quantile(double q) {
+    if (_count == 0)
+        return NAN;
+
+    int bins = (int)_counts.size() - 2;
+    double width = (_upper - _lower) / bins;
+    double rank = q * _count;
+
+    // Walk through the bins until the rank is reached
+    double cumulative = 0;
+    for (size_t i = 0; i < _counts.size(); i++) {
+        if (_counts[i] == 0 || cumulative + _counts[i] < rank) {
+            cumulative += _counts[i];
+            continue;
+        }
+
+        // The outer bins are bounded by the exact extremes
+        if (i == 0)
+            return _minimum;
+        if (i == _counts.size() - 1)
+            return _maximum;
+
+        // Interpolate within the bin
+        double fraction = (rank - cumulative) / _counts[i];
+        double value = _lower + (i - 1 + fraction) * width;
+        return max(_minimum, min(_maximum, value));
+    }
+
+    return _maximum;
+}
+
+double QuantileSketch::getMinimum() {
+    return _minimum;
+}
+
+double QuantileSketch::getMaximum() {
+    return _maximum;
+}
+
+long QuantileSketch::getCount() {
+    return _count;
+}
+
+#pragma mark SUMMARY
+
+Summary::Summary(double sampleHours, double tolerance) {
+    _sampleHours = sampleHours;
+    _tolerance = tolerance;
+    _nominalVoltage = 0;
+    _samples = 0;
+}
+
+void Summary::setup(vector<string> names, vector<int> kinds, vector<int> phases, int numberOfPhases, double nominalVoltage) {
+    if (names.size() != kinds.size() || names.size() != phases.size()) {
+        cout << "ERROR : Element names, kinds and phases do not match." << endl;
+        return;
+    }
+
+    _names = names;
+    _kinds = kinds;
+    _phases = phases;
+    _nominalVoltage = nominalVoltage;
+    _samples = 0;
+
+    // Houses get a sketch around the nominal voltage, lines a peak current
+    QuantileSketch sketch((1.0 - SKETCH_RANGE) * nominalVoltage,
+                          (1.0 + SKETCH_RANGE) * nominalVoltage);
+    _voltages.clear();
+    _samplesOutside.clear();
+    _peakCurrents.clear();
+    for (size_t i = 0; i < names.size(); i++) {
+        if (kinds[i] == SummaryHouse) {
+            _voltages.push_back(sketch);
+            _samplesOutside.push_back(0);
+        } else {
+            _peakCurrents.push_back(0);
+        }
+    }
+
+    _losses.assign(numberOfPhases + 1, 0.0);
+}
+
+bool Summary::isSetUp() {
+    return !_names.empty();
+}
+
+void Summary::addSample(const vector<double> &voltages, const vector<double> &currents, const vector<double> &losses) {
+    if (voltages.size() != _names.size()
+        || currents.size() != _names.size()
+        || losses.size() != _names.size()) {
+        cout << "ERROR : Sample does not match the summarised elements." << endl;
+        return;
+    }
+
+    double lowerLimit = (1.0 - _tolerance) * _nominalVoltage;
+    double upperLimit = (1.0 + _tolerance) * _nominalVoltage;
+
+    size_t house = 0;
+    size_t line = 0;
+    for (size_t i = 0; i < _names.size(); i++) {
+        if (_kinds[i] == SummaryHouse) {
+            _voltages[house].add(voltages[i]);
+            if (voltages[i] < lowerLimit || voltages[i] > upperLimit)
+                _samplesOutside[house]++;
+            house++;
+        } else {
+            _peakCurrents[line] = max(_peakCurrents[line], currents[i]);
+            line++;
+        }
+
+        // Losses are summed up per phase
+        if (_phases[i] >= 0 && _phases[i] < _losses.size())
+            _losses[_phases[i]] += losses[i] * _sampleHours;
+    }
+
+    _samples++;
+}
+
+void Summary::merge(Summary *summary) {
+    // Nothing to merge from an empty summary
+    if (!summary->isSetUp())
+        return;
+
+    if (!isSetUp()) {
+        *this = *summary;
+        return;
+    }
+
+    if (summary->_names.size() != _names.size()
+        || summary->_losses.size() != _losses.size()) {
+        cout << "ERROR : Can not merge summaries of different circuits." << endl;
+        return;
+    }
+
+    for (size_t i = 0; i < _voltages.size(); i++) {
+        _voltages[i].merge(summary->_voltages[i]);
+        _samplesOutside[i] += summary->_samplesOutside[i];
+    }
+
+    for (size_t i = 0; i < _peakCurrents.size(); i++)
+        _peakCurrents[i] = max(_peakCurrents[i], summary->_peakCurrents[i]);
+
+    for (size_t i = 0; i < _losses.size(); i++)
+        _losses[i] += summary->_losses[i];
+
+    _samples += summary->_samples;
+}
+
+long Summary::getSamples() {
+    return _samples;
+}
+
+void Summary::save(string path) {
+    TraceSpan span("write summary");
+    MemoryStageScope stage(WriteStage);
+    
+    if (!isSetUp()) {
+        cout << "ERROR : Nothing has been summarised." << endl;
+        return;
+    }
+
+    // Collect houses and lines separately
+    vector<string> houses;
+    vector<double> houseValues;
+    vector<string> lines;
+    vector<double> lineValues;
+
+    size_t house = 0;
+    size_t line = 0;
+    for (size_t i = 0; i < _names.size(); i++) {
+        if (_kinds[i] == SummaryHouse) {
+            QuantileSketch &sketch = _voltages[house];
+            houses.push_back(_names[i]);
+            houseValues.push_back(_phases[i]);
+            houseValues.push_back(sketch.getMinimum());
+            houseValues.push_back(sketch.quantile(0.05));
+            houseValues.push_back(sketch.quantile(0.5));
+            houseValues.push_back(sketch.quantile(0.95));
+            houseValues.push_back(sketch.getMaximum());
+            houseValues.push_back(_samplesOutside[house] * _sampleHours);
+            house++;
+        } else {
+            lines.push_back(_names[i]);
+            lineValues.push_back(_phases[i]);
+            lineValues.push_back(_peakCurrents[line]);
+            line++;
+        }
+    }
+
+    CSVWriter houseOutput(path + "_houses.csv");
+    if (!houseOutput.isOpen()) {
+        cout << "ERROR : Could not generate <" << path << "_houses.csv>." << endl;
+        return;
+    }
+    houseOutput.write("Name,Phase,V_min,V_p5,V_p50,V_p95,V_max,Hours_outside\n");
+    houseOutput.writeRows(houses, houseValues, 7);
+    houseOutput.close();
+
+    CSVWriter lineOutput(path + "_lines.csv");
+    if (!lineOutput.isOpen()) {
+        cout << "ERROR : Could not generate <" << path << "_lines.csv>." << endl;
+        return;
+    }
+    lineOutput.write("Name,Phase,I_peak\n");
+    lineOutput.writeRows(lines, lineValues, 2);
+    lineOutput.close();
+
+    // Return line first, then each phase
+    vector<string> phases;
+    for (size_t i = 0; i < _losses.size(); i++) {
+        stringstream phase;
+        if (i == 0)
+            phase << "return";
+        else
+            phase << "phase_" << i;
+        phases.push_back(phase.str());
+    }
+
+    CSVWriter lossOutput(path + "_losses.csv");
+    if (!lossOutput.isOpen()) {
+        cout << "ERROR : Could not generate <" << path << "_losses.csv>." << endl;
+        return;
+    }
+    lossOutput.write("Line,Losses(Wh)\n");
+    lossOutput.writeRows(phases, _losses, 1);
+    lossOutput.close();
+
+    cout << " Summary of " << _samples << " samples written to:" << endl;
+    cout << path << "_*.csv" << endl;
+}
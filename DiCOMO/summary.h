@@ -0,0 +1,110 @@
+//
+//  summary.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__summary__
+#define __DiCOMO__summary__
+
+//  Streaming statistics of a time-series run. Instead of storing every
+//  sample, each solve updates a fixed set of accumulators per element:
+//  voltage extremes, percentiles and time outside the voltage limits for each
+//  house, the peak current for each line segment and the energy lost on each
+//  phase and on the return line. Summaries of the same circuit can be merged,
+//  so separate threads may each summarise a part of the run.
+
+#include "csvWriter.h"
+#include "trace.h"
+#include "memoryTracker.h"
+
+#include <stdint.h>
+
+// Number of bins and relative range (around the nominal voltage) of the
+// voltage percentile sketches. 400 bins over ±20% resolve 0.1% of nominal
+#define SKETCH_BINS         400
+#define SKETCH_RANGE        0.2
+
+// Role of an element in the summary
+enum summaryKind {
+    SummaryHouse    = 0,
+    SummaryLine     = 1,
+};
+
+// A mergeable quantile sketch. Values are counted in equally wide bins over
+// a fixed range, with one more bin below and above it. Merging two sketches
+// simply adds their counts, and quantiles are exact up to the bin width
+class QuantileSketch {
+protected:
+    double _lower;
+    double _upper;
+    vector<uint32_t> _counts;
+
+    // Exact extremes to bound the outer bins
+    double _minimum;
+    double _maximum;
+    long _count;
+
+public:
+    QuantileSketch(double lower = 0.0, double upper = 1.0, int bins = SKETCH_BINS);
+
+    void add(double value);
+    void merge(const QuantileSketch &sketch);
+
+    // Returns the value below which the fraction q of all values lie
+    double quantile(double q);
+
+    double getMinimum();
+    double getMaximum();
+    long getCount();
+};
+
+class Summary {
+protected:
+    // Description of the summarised elements
+    vector<string> _names;
+    vector<int> _kinds;
+    vector<int> _phases;
+
+    // Voltage limits are given relative to the nominal voltage
+    double _nominalVoltage;
+    double _tolerance;
+
+    // Duration of a sample in hours
+    double _sampleHours;
+
+    long _samples;
+
+    // Accumulators per house
+    vector<QuantileSketch> _voltages;
+    vector<long> _samplesOutside;
+
+    // Accumulators per line segment
+    vector<double> _peakCurrents;
+
+    // Energy lost in Wh, index 0 is the return line and index n phase n
+    vector<double> _losses;
+
+public:
+    Summary(double sampleHours = 0.5, double tolerance = 0.1);
+
+    // Describes the elements. Must be called before the first sample
+    void setup(vector<string> names, vector<int> kinds, vector<int> phases, int numberOfPhases, double nominalVoltage);
+    bool isSetUp();
+
+    // Adds one sample. For each element the voltage across it, the current
+    // through it and the power lost in it are passed
+    void addSample(const vector<double> &voltages, const vector<double> &currents, const vector<double> &losses);
+
+    // Merges a summary of the same circuit into this one
+    void merge(Summary *summary);
+
+    long getSamples();
+
+    // Writes "<path>_houses.csv", "<path>_lines.csv" and "<path>_losses.csv"
+    void save(string path);
+};
+
+#endif /* defined(__DiCOMO__summary__) */
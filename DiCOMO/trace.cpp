@@ -0,0 +1,100 @@
+//
+//  trace.cpp
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "trace.h"
+
+atomic<bool> Trace::_enabled(false);
+double Trace::_origin = 0.0;
+vector<traceBuffer *> Trace::_buffers;
+mutex Trace::_buffersMutex;
+
+// Buffer of the calling thread, registered on its first span
+static __thread traceBuffer *currentBuffer = NULL;
+
+void Trace::enable() {
+    _origin = now();
+    _enabled = true;
+}
+
+bool Trace::isEnabled() {
+    return _enabled.load(memory_order_relaxed);
+}
+
+void Trace::record(const char *name, double start, double duration) {
+    traceEvent event;
+    event.name = name;
+    event.start = start - _origin;
+    event.duration = duration;
+    threadBuffer()->events.push_back(event);
+}
+
+bool Trace::save(string path) {
+    ofstream output(path.c_str());
+    if (!output.is_open()) {
+        cout << "ERROR : Could not generate <" << path << ">." << endl;
+        return false;
+    }
+
+    lock_guard<mutex> lock(_buffersMutex);
+
+    output << fixed << setprecision(3);
+    output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+
+    bool first = true;
+    for (size_t i = 0; i < _buffers.size(); i++) {
+        traceBuffer *buffer = _buffers[i];
+
+        // Name the thread so the viewer labels its row
+        output << (first ? "" : ",\n");
+        output << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread;
+        output << ", \"args\": {\"name\": \"" << (buffer->thread == 0 ? "main" : "worker") << " " << buffer->thread << "\"}}";
+        first = false;
+
+        for (size_t e = 0; e < buffer->events.size(); e++) {
+            traceEvent &event = buffer->events[e];
+            output << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1";
+            output << ", \"tid\": " << buffer->thread;
+            output << ", \"ts\": " << event.start << ", \"dur\": " << event.duration << "}";
+        }
+    }
+
+    output << endl << "]}" << endl;
+    output.close();
+
+    return true;
+}
+
+double Trace::now() {
+    return chrono::duration<double, micro>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#pragma mark PROTECTED
+
+traceBuffer *Trace::threadBuffer() {
+    if (!currentBuffer) {
+        // Only the first span of each thread takes the lock
+        lock_guard<mutex> lock(_buffersMutex);
+        currentBuffer = new traceBuffer();
+        currentBuffer->thread = (int) _buffers.size();
+        _buffers.push_back(currentBuffer);
+    }
+
+    return currentBuffer;
+}
+
+#pragma mark TRACE SPAN
+
+TraceSpan::TraceSpan(const char *name) {
+    _name = name;
+    _start = Trace::isEnabled() ? Trace::now() : 0.0;
+}
+
+TraceSpan::~TraceSpan() {
+    if (Trace::isEnabled() && _start != 0.0)
+        Trace::record(_name, _start, Trace::now() - _start);
+}
@@ -0,0 +1,78 @@
+//
+//  trace.h
+//  DiCOMO
+//
+//  Created by agent on 18.10.26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __DiCOMO__trace__
+#define __DiCOMO__trace__
+
+//  Timeline of a run for the Chrome/Perfetto trace viewer. Scoped spans are
+//  placed around loading, assembly, solves and writes. Every thread records
+//  into its own buffer, which is only registered (under a lock) the first
+//  time the thread records a span, so recording itself never locks. Once all
+//  threads are done, the buffers are written as trace-event JSON that can be
+//  opened in chrome://tracing or ui.perfetto.dev. While tracing is disabled
+//  a span only checks a flag.
+
+#include "backbone.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// A completed span. Names must be string literals, they are not copied
+struct traceEvent {
+    const char *name;
+    double start;
+    double duration;
+};
+
+// Spans recorded by one thread
+struct traceBuffer {
+    int thread;
+    vector<traceEvent> events;
+};
+
+class Trace {
+protected:
+    static atomic<bool> _enabled;
+    static double _origin;
+
+    // Buffers of all threads that have recorded, in order of registration
+    static vector<traceBuffer *> _buffers;
+    static mutex _buffersMutex;
+
+public:
+    // Starts recording, timestamps are relative to this call
+    static void enable();
+    static bool isEnabled();
+
+    // Adds a completed span to the buffer of the calling thread
+    static void record(const char *name, double start, double duration);
+
+    // Writes all buffers as trace-event JSON. Must only be called when no
+    // other thread is recording anymore
+    static bool save(string path);
+
+    // Monotonic wall-clock time in microseconds
+    static double now();
+
+protected:
+    static traceBuffer *threadBuffer();
+};
+
+// Records the time from its construction until the end of its scope
+class TraceSpan {
+protected:
+    const char *_name;
+    double _start;
+
+public:
+    TraceSpan(const char *name);
+    ~TraceSpan();
+};
+
+#endif /* defined(__DiCOMO__trace__) */